@@ -0,0 +1,363 @@
+/*
+ * Měření výkonu tabulek s rozptýlenými položkami
+ *
+ * Porovnává dynamickou tabulku se zřetězenými synonymy a s otevřeným
+ * adresováním, s klíči volajícího i s vlastními kopiemi klíčů, na stejné
+ * sadě klíčů. Souběžnou tabulku měří pro 1 až [počet vláken] vláken
+ * (výchozí je počet procesorů) proti dynamické tabulce s jedním globálním
+ * zámkem; zároveň kontroluje, že čtoucí vlákna vidí jen správné hodnoty
+ * a že počet prvků na konci odpovídá.
+ *
+ * Pro každé nastavení dynamické tabulky také uloží binární obraz
+ * (ht_dyn_save) a porovná obnovu tabulky vkládáním s načtením obrazu
+ * (ht_dyn_load) a s jeho namapováním (ht_image_map); ve výsledku obnovy
+ * kontroluje všechny klíče.
+ *
+ * Přeložený s -DIAL_STATS vypíše po měření každé tabulky její počítadla
+ * (stats.h) jako JSON. Měřené časy pak zahrnují i jejich režii.
+ *
+ * Překlad:  cc -O2 -pthread [-DIAL_STATS] -I<adresář s hashtable.h> bench.c \
+ *               hashtable.c hashtable_oa.c hashtable_conc.c hashtable_image.c ht_hash.c \
+ *               pool.c stats.c -o bench
+ * Spuštění: ./bench [počet klíčů] [počet vláken]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "hashtable_conc.h"
+#include "hashtable_ext.h"
+#include "stats.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Bytes reserved for one generated key.
+#define BENCH_KEY_LEN 24
+// Keys per ht_dyn_get_many call.
+#define BENCH_BATCH 64
+// Operations per thread in the concurrent benchmark; one in BENCH_WRITE_EVERY is a write.
+#define BENCH_CONC_OPS 2000000
+#define BENCH_WRITE_EVERY 10
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+ * Vygeneruje count navzájem různých klíčů s prefixem prefix. Klíče s jiným
+ * prefixem poslouží jako klíče, které v tabulce nejsou.
+ */
+static char **bench_keys(size_t count, const char *prefix) {
+    char **keys = (char **)malloc(count * sizeof(char *));
+    char *storage = (char *)malloc(count * BENCH_KEY_LEN);
+    if (keys == NULL || storage == NULL) {
+        fprintf(stderr, "bench: out of memory\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = storage + i * BENCH_KEY_LEN;
+        snprintf(keys[i], BENCH_KEY_LEN, "%s%zx", prefix, i * 2654435761u);
+    }
+    return keys;
+}
+
+static void bench_free_keys(char **keys) {
+    free(keys[0]);
+    free(keys);
+}
+
+static void bench_report(const char *backend, const char *op, size_t count, double ns) {
+    printf("%-12s %-10s %10zu %10.1f ns/op\n", backend, op, count, ns / count);
+}
+
+static void bench_backend(const ht_dyn_config_t *config, const char *name, char **keys, char **missing, size_t count) {
+    ht_dyn_table_t table;
+    ht_dyn_init_config(&table, config);
+    // Guards against the compiler dropping the lookups.
+    volatile float sink = 0;
+
+    double start = bench_now();
+    for (size_t i = 0; i < count; i++) {
+        ht_dyn_insert(&table, keys[i], (float)i);
+    }
+    bench_report(name, "insert", count, bench_now() - start);
+
+    start = bench_now();
+    for (size_t i = 0; i < count; i++) {
+        sink += *ht_dyn_get(&table, keys[i]);
+    }
+    bench_report(name, "get-hit", count, bench_now() - start);
+
+    start = bench_now();
+    for (size_t i = 0; i < count; i++) {
+        sink += ht_dyn_get(&table, missing[i]) != NULL;
+    }
+    bench_report(name, "get-miss", count, bench_now() - start);
+
+    // Same lookups as get-hit, resolved BENCH_BATCH keys per call.
+    float *values[BENCH_BATCH];
+    start = bench_now();
+    for (size_t i = 0; i < count; i += BENCH_BATCH) {
+        size_t batch = count - i < BENCH_BATCH ? count - i : BENCH_BATCH;
+        ht_dyn_get_many(&table, keys + i, batch, values);
+        sink += *values[0];
+    }
+    bench_report(name, "get-many", count, bench_now() - start);
+
+    start = bench_now();
+    for (size_t i = 0; i < count; i++) {
+        ht_dyn_delete(&table, keys[i]);
+    }
+    bench_report(name, "delete", count, bench_now() - start);
+
+    ht_dyn_delete_all(&table);
+    (void)sink;
+}
+
+/*
+ * Porovná, jak rychle je tabulka znovu k dispozici: postavením vkládáním
+ * (rebuild), načtením uloženého obrazu do nové tabulky (load) a
+ * namapováním obrazu (map). V načtené tabulce i v namapovaném obrazu
+ * zkontroluje hodnoty všech klíčů a že chybějící klíče nenajde; při
+ * rozdílu vypíše INCONSISTENT.
+ */
+static void bench_image(const ht_dyn_config_t *config, const char *name, char **keys, char **missing, size_t count) {
+    const char *dir = getenv("TMPDIR");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/ial_bench_%ld.img", dir != NULL ? dir : "/tmp", (long)getpid());
+
+    ht_dyn_table_t table;
+    ht_dyn_init_config(&table, config);
+    double start = bench_now();
+    for (size_t i = 0; i < count; i++) {
+        ht_dyn_insert(&table, keys[i], (float)i);
+    }
+    double rebuild = bench_now() - start;
+
+    start = bench_now();
+    bool ok = ht_dyn_save(&table, path);
+    double save = bench_now() - start;
+    ht_dyn_delete_all(&table);
+    if (!ok) {
+        perror("bench: ht_dyn_save");
+        return;
+    }
+
+    start = bench_now();
+    ok = ht_dyn_load(&table, path, config);
+    double load = bench_now() - start;
+    size_t errors = ok ? 0 : 1;
+    for (size_t i = 0; ok && i < count; i++) {
+        float *value = ht_dyn_get(&table, keys[i]);
+        errors += value == NULL || *value != (float)i;
+        errors += ht_dyn_get(&table, missing[i]) != NULL;
+    }
+    ht_dyn_delete_all(&table);
+
+    ht_image_t image;
+    start = bench_now();
+    ok = ht_image_map(&image, path, config->hash);
+    double map = bench_now() - start;
+    double get = 0;
+    if (ok) {
+        // Guards against the compiler dropping the lookups.
+        volatile float sink = 0;
+        start = bench_now();
+        for (size_t i = 0; i < count; i++) {
+            sink += *ht_image_get(&image, keys[i]);
+        }
+        get = bench_now() - start;
+        (void)sink;
+        for (size_t i = 0; i < count; i++) {
+            const float *value = ht_image_get(&image, keys[i]);
+            errors += value == NULL || *value != (float)i;
+            errors += ht_image_get(&image, missing[i]) != NULL;
+        }
+        ht_image_unmap(&image);
+    } else {
+        errors++;
+    }
+    remove(path);
+
+    printf("%-12s image %10zu keys: rebuild %.2f ms, save %.2f ms, load %.2f ms, map %.3f ms, "
+           "mapped get-hit %.1f ns/op%s\n",
+           name, count, rebuild / 1e6, save / 1e6, load / 1e6, map / 1e6, get / count,
+           errors ? "  INCONSISTENT" : "");
+}
+
+typedef struct bench_conc_thread {
+    pthread_t thread;
+    size_t id;              // index of the thread
+    size_t threads;         // number of threads
+    char **keys;            // shared key set, value of keys[i] is i
+    size_t count;           // number of keys
+    ht_conc_table_t *conc;  // concurrent table, or NULL for the locked one
+    ht_dyn_table_t *locked; // dynamic table behind one global mutex
+    pthread_mutex_t *lock;  // the global mutex
+    long present;           // change of the item count made by this thread
+    size_t errors;          // wrong values seen by this thread
+} bench_conc_thread_t;
+
+/*
+ * Pracovní vlákno: čte náhodné klíče a každou BENCH_WRITE_EVERY-tou
+ * operací smaže nebo znovu vloží jeden z "vlastních" klíčů (i % threads
+ * == id), takže konečný počet prvků lze spočítat.
+ */
+static void *bench_conc_worker(void *arg) {
+    bench_conc_thread_t *self = (bench_conc_thread_t *)arg;
+    uint64_t state = 0x9E3779B97F4A7C15ull * (self->id + 1);
+    size_t own = self->id;
+    // Every pass over the owned keys first deletes them all, the next one inserts them back.
+    bool deleting = true;
+
+    for (size_t op = 0; op < BENCH_CONC_OPS; op++) {
+        // xorshift64 is enough to spread the keys.
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        size_t k = state % self->count;
+        float value = 0;
+        bool found;
+
+        if (op % BENCH_WRITE_EVERY == 0) {
+            if (self->conc) {
+                deleting ? ht_conc_delete(self->conc, self->keys[own]) : (void)ht_conc_insert(self->conc, self->keys[own], (float)own);
+            } else {
+                pthread_mutex_lock(self->lock);
+                deleting ? ht_dyn_delete(self->locked, self->keys[own]) : ht_dyn_insert(self->locked, self->keys[own], (float)own);
+                pthread_mutex_unlock(self->lock);
+            }
+            self->present += deleting ? -1 : 1;
+            own += self->threads;
+            if (own >= self->count) {
+                own = self->id;
+                deleting = !deleting;
+            }
+            continue;
+        }
+
+        if (self->conc) {
+            found = ht_conc_get(self->conc, self->keys[k], &value);
+        } else {
+            pthread_mutex_lock(self->lock);
+            float *slot = ht_dyn_get(self->locked, self->keys[k]);
+            found = slot != NULL;
+            value = found ? *slot : 0;
+            pthread_mutex_unlock(self->lock);
+        }
+        self->errors += found && value != (float)k;
+    }
+    if (self->conc) {
+        ht_conc_thread_exit();
+    }
+    return NULL;
+}
+
+/*
+ * Souběžný test: tabulka obsahuje všechny klíče, vlákna ji čtou a mění.
+ */
+static void bench_conc(const char *name, bool concurrent, char **keys, size_t count, size_t threads) {
+    ht_conc_table_t conc;
+    ht_dyn_table_t locked;
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    bench_conc_thread_t *workers = (bench_conc_thread_t *)calloc(threads, sizeof(bench_conc_thread_t));
+    if (workers == NULL || (concurrent && !ht_conc_init(&conc, count))) {
+        fprintf(stderr, "bench: out of memory\n");
+        exit(1);
+    }
+    ht_dyn_init(&locked);
+    for (size_t i = 0; i < count; i++) {
+        concurrent ? (void)ht_conc_insert(&conc, keys[i], (float)i) : ht_dyn_insert(&locked, keys[i], (float)i);
+    }
+
+    double start = bench_now();
+    for (size_t t = 0; t < threads; t++) {
+        workers[t] = (bench_conc_thread_t){
+            .id = t, .threads = threads, .keys = keys, .count = count,
+            .conc = concurrent ? &conc : NULL, .locked = &locked, .lock = &lock,
+        };
+        pthread_create(&workers[t].thread, NULL, bench_conc_worker, &workers[t]);
+    }
+    long present = (long)count;
+    size_t errors = 0;
+    for (size_t t = 0; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+        errors += workers[t].errors;
+    }
+    double elapsed = bench_now() - start;
+
+    // Readers must only see the values stored for their keys and the count
+    // must match what the writers left behind.
+    for (size_t t = 0; t < threads; t++) {
+        present += workers[t].present;
+    }
+    size_t final_count = concurrent ? atomic_load(&conc.count) : locked.count;
+    size_t ops = threads * BENCH_CONC_OPS;
+    printf("%-12s %2zu threads %8.2f Mops/s%s\n", name, threads, ops / elapsed * 1e3,
+           errors || final_count != (size_t)present ? "  INCONSISTENT" : "");
+
+    if (concurrent) {
+        ht_conc_destroy(&conc);
+    }
+    ht_dyn_delete_all(&locked);
+    free(workers);
+}
+
+#ifdef IAL_STATS
+/*
+ * Vypíše počítadla nasbíraná od posledního výpisu jako JSON a vynuluje je.
+ */
+static void bench_stats(const char *name) {
+    stats_t stats;
+    char json[4096];
+    stats_collect(&stats);
+    stats_json(&stats, json, sizeof(json));
+    printf("%s stats %s\n", name, json);
+    stats_reset();
+}
+#endif
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = argc > 2 ? strtoul(argv[2], NULL, 10) : (size_t)(cpus > 0 ? cpus : 1);
+    if (count == 0 || max_threads == 0) {
+        fprintf(stderr, "usage: %s [key count] [thread count]\n", argv[0]);
+        return 1;
+    }
+    char **keys = bench_keys(count, "key:");
+    char **missing = bench_keys(count, "miss:");
+
+    const struct {
+        const char *name;
+        ht_dyn_config_t config;
+    } setups[] = {
+        {"chained", {ht_hash_wy, HT_HASH_DEFAULT_SEED, HT_BACKEND_CHAINED, false}},
+        {"open", {ht_hash_wy, HT_HASH_DEFAULT_SEED, HT_BACKEND_OPEN, false}},
+        {"chained+own", {ht_hash_wy, HT_HASH_DEFAULT_SEED, HT_BACKEND_CHAINED, true}},
+        {"open+own", {ht_hash_wy, HT_HASH_DEFAULT_SEED, HT_BACKEND_OPEN, true}},
+    };
+    for (size_t i = 0; i < sizeof(setups) / sizeof(setups[0]); i++) {
+        bench_backend(&setups[i].config, setups[i].name, keys, missing, count);
+#ifdef IAL_STATS
+        bench_stats(setups[i].name);
+#endif
+    }
+
+    for (size_t i = 0; i < sizeof(setups) / sizeof(setups[0]); i++) {
+        bench_image(&setups[i].config, setups[i].name, keys, missing, count);
+    }
+
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        bench_conc("concurrent", true, keys, count, threads);
+        bench_conc("global-lock", false, keys, count, threads);
+    }
+
+    bench_free_keys(keys);
+    bench_free_keys(missing);
+    return 0;
+}
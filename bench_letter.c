@@ -0,0 +1,226 @@
+/*
+ * Měření propustnosti letter_count
+ *
+ * Vygeneruje [počet MiB] vstupu třikrát: jako text v ASCII (písmena obou
+ * velikostí, mezery a interpunkce), jako český text v UTF-8 a jako náhodné
+ * bajty. Na každém změří letter_count (vektorová verze, podle překladu SSE2
+ * nebo AVX2) a referenční skalární letter_count_scalar a zkontroluje, že
+ * vzniklé stromy jsou stejné; pokud ne, vypíše INCONSISTENT. Pak změří
+ * letter_count_parallel pro 1 až [počet vláken] vláken (výchozí je počet
+ * procesorů), totéž s předem vytvořeným poolem vláken (letter_count_pool_run)
+ * a u obou vypíše zrychlení proti jednomu vláknu a jeho podíl na počtu
+ * vláken; řádky s více vlákny, než je procesorů, označí. Nakonec změří
+ * počítání všech bajtů (letter_count_bytes) a znaků UTF-8
+ * (letter_count_utf8); u nich kontroluje, že počty dají dohromady délku
+ * vstupu, a vypíše počet neplatných posloupností.
+ *
+ * Překlad:  cc -O2 [-mavx2] -pthread -I<adresář s btree.h> bench_letter.c exa.c \
+ *               btree.c btree_pool.c pool.c <soubory zadání> -o bench_letter
+ * Spuštění: ./bench_letter [počet MiB] [počet vláken]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../btree.h"
+#include "btree_ext.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+void letter_count(bst_node_t **tree, char *input);
+
+typedef void (*bench_letter_t)(bst_node_t **tree, char *input);
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t bench_mix(uint64_t x) {
+    // splitmix64 finalizer: cheap, and every input byte depends on all bits of x.
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+typedef enum bench_input_kind { BENCH_TEXT, BENCH_CZECH, BENCH_RANDOM } bench_input_kind_t;
+
+/*
+ * Vstup o size bajtech ukončený nulou. Text vybírá znaky z krátké
+ * abecedy, český text navíc každý osmý znak z dvoubajtových písmen s
+ * diakritikou, jinak jsou bajty náhodné (kromě nuly).
+ */
+static char *bench_input(size_t size, bench_input_kind_t kind) {
+    static const char alphabet[] = "eeettaoinshrdlucmfwypvbgkjqxzETAOINS      .,;!?-_0123456789\n";
+    static const char *const accented[] = {"č", "ř", "ž", "š", "ě", "á", "í", "é", "ů", "ý", "Č", "Ř"};
+    char *input = (char *)malloc(size + 1);
+    if (input == NULL) {
+        fprintf(stderr, "bench_letter: out of memory\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < size; i++) {
+        uint64_t r = bench_mix(i);
+        if (kind == BENCH_RANDOM) {
+            input[i] = (char)(r % 255 + 1);
+        } else if (kind == BENCH_CZECH && r % 8 == 0 && i + 1 < size) {
+            const char *letter = accented[(r >> 8) % (sizeof(accented) / sizeof(accented[0]))];
+            input[i] = letter[0];
+            input[++i] = letter[1];
+        } else {
+            input[i] = alphabet[r % (sizeof(alphabet) - 1)];
+        }
+    }
+    input[size] = '\0';
+    return input;
+}
+
+static bool bench_same(bst_node_t *a, bst_node_t *b) {
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+    return a->key == b->key && a->value == b->value && bench_same(a->left, b->left) &&
+           bench_same(a->right, b->right);
+}
+
+static void bench_report(const char *input_name, const char *name, size_t size, double elapsed, bst_node_t *tree,
+                         bst_node_t *expected) {
+    printf("%-6s %-7s %6zu MiB %8.2f GB/s%s\n", input_name, name, size >> 20, size / elapsed,
+           expected != NULL && !bench_same(tree, expected) ? "  INCONSISTENT" : "");
+}
+
+/*
+ * Změří count na vstupu input o size bajtech a výsledek porovná se stromem
+ * expected (pokud není NULL). Vrací postavený strom.
+ */
+static bst_node_t *bench_run(const char *input_name, const char *name, bench_letter_t count, char *input,
+                             size_t size, bst_node_t *expected) {
+    bst_node_t *tree;
+    double start = bench_now();
+    count(&tree, input);
+    bench_report(input_name, name, size, bench_now() - start, tree, expected);
+    return tree;
+}
+
+/*
+ * Vypíše řádek měření s threads vlákny a k němu zrychlení proti měření
+ * s jedním vláknem (single) a účinnost, tj. zrychlení dělené počtem
+ * vláken. Běží-li víc vláken než procesorů (cpus), zrychlení nic neříká.
+ */
+static void bench_report_scaling(const char *input_name, const char *name, size_t size, double elapsed,
+                                 double single, size_t threads, size_t cpus, bst_node_t *tree,
+                                 bst_node_t *expected) {
+    double speedup = single / elapsed;
+    printf("%-6s %-7s %6zu MiB %8.2f GB/s %6.2fx %4.0f %%%s%s\n", input_name, name, size >> 20, size / elapsed,
+           speedup, 100 * speedup / threads, threads > cpus ? "  more threads than CPUs" : "",
+           expected != NULL && !bench_same(tree, expected) ? "  INCONSISTENT" : "");
+}
+
+/*
+ * Změří letter_count_parallel s 1, 2, 4, … vlákny až po max_threads a pak
+ * letter_count_pool_run s poolem stejné velikosti; cpus je počet
+ * procesorů.
+ */
+static void bench_parallel(const char *input_name, char *input, size_t size, size_t max_threads, size_t cpus,
+                           bst_node_t *expected) {
+    double single_thread = 0, single_pool = 0;
+    for (size_t threads = 1; threads <= max_threads;
+         threads = threads < max_threads && threads * 2 > max_threads ? max_threads : threads * 2) {
+        char name[32];
+        snprintf(name, sizeof(name), "%zu thr", threads);
+        bst_node_t *tree;
+        double start = bench_now();
+        letter_count_parallel(&tree, input, threads);
+        double elapsed = bench_now() - start;
+        if (threads == 1) {
+            single_thread = elapsed;
+        }
+        bench_report_scaling(input_name, name, size, elapsed, single_thread, threads, cpus, tree, expected);
+        bst_dispose(&tree);
+
+        // The same with threads that already exist, as repeated jobs see them.
+        letter_count_pool_t pool;
+        if (!letter_count_pool_init(&pool, threads)) {
+            fprintf(stderr, "bench_letter: out of memory\n");
+            exit(1);
+        }
+        snprintf(name, sizeof(name), "%zu pool", pool.threads);
+        start = bench_now();
+        letter_count_pool_run(&pool, &tree, input);
+        elapsed = bench_now() - start;
+        if (threads == 1) {
+            single_pool = elapsed;
+        }
+        bench_report_scaling(input_name, name, size, elapsed, single_pool, pool.threads, cpus, tree, expected);
+        bst_dispose(&tree);
+        letter_count_pool_destroy(&pool);
+    }
+}
+
+static bool bench_sum(letter_tree_node_t *node, void *context) {
+    *(size_t *)context += node->value;
+    return true;
+}
+
+static bool bench_sum_bytes(letter_tree_node_t *node, void *context) {
+    // Code points count once per byte of their UTF-8 encoding; U+FFFD stands for one or more bytes.
+    size_t bytes = node->key < 0x80 ? 1 : node->key < 0x800 ? 2 : node->key < 0x10000 ? 3 : 4;
+    *(size_t *)context += node->value * bytes;
+    return true;
+}
+
+/*
+ * Změří letter_count_bytes a letter_count_utf8.
+ */
+static void bench_full(const char *input_name, char *input, size_t size) {
+    letter_tree_node_t *tree;
+    double start = bench_now();
+    bool ok = letter_count_bytes(&tree, input, size);
+    double elapsed = bench_now() - start;
+    size_t total = 0;
+    letter_tree_range(tree, 0, UINT32_MAX, bench_sum, &total);
+    printf("%-6s %-7s %6zu MiB %8.2f GB/s%s\n", input_name, "bytes", size >> 20, size / elapsed,
+           !ok || total != size ? "  INCONSISTENT" : "");
+    letter_tree_dispose(&tree);
+
+    size_t invalid;
+    start = bench_now();
+    ok = letter_count_utf8(&tree, input, size, &invalid);
+    elapsed = bench_now() - start;
+    total = 0;
+    letter_tree_range(tree, 0, UINT32_MAX, bench_sum_bytes, &total);
+    printf("%-6s %-7s %6zu MiB %8.2f GB/s %6zu distinct %9zu invalid%s\n", input_name, "utf8", size >> 20,
+           size / elapsed, letter_tree_size(tree), invalid, !ok || (invalid == 0 && total != size) ? "  INCONSISTENT" : "");
+    letter_tree_dispose(&tree);
+}
+
+int main(int argc, char *argv[]) {
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 256;
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t cpus = online > 0 ? (size_t)online : 1;
+    size_t max_threads = argc > 2 ? strtoul(argv[2], NULL, 10) : cpus;
+    if (megabytes == 0 || max_threads == 0) {
+        fprintf(stderr, "usage: %s [MiB of input] [thread count]\n", argv[0]);
+        return 1;
+    }
+    size_t size = megabytes << 20;
+    const struct {
+        const char *name;
+        bench_input_kind_t kind;
+    } inputs[] = {{"text", BENCH_TEXT}, {"czech", BENCH_CZECH}, {"random", BENCH_RANDOM}};
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+        const char *input_name = inputs[i].name;
+        char *input = bench_input(size, inputs[i].kind);
+        bst_node_t *scalar = bench_run(input_name, "scalar", letter_count_scalar, input, size, NULL);
+        bst_node_t *vector = bench_run(input_name, "vector", letter_count, input, size, scalar);
+        bench_parallel(input_name, input, size, max_threads, cpus, scalar);
+        bench_full(input_name, input, size);
+        bst_dispose(&scalar);
+        bst_dispose(&vector);
+        free(input);
+    }
+    return 0;
+}
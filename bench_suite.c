@@ -0,0 +1,643 @@
+/*
+ * Sada měření všech kontejnerů se strojově čitelným výstupem
+ *
+ * Na rozdíl od bench.c, bench_tree.c a bench_letter.c, které vypisují text
+ * pro člověka, měří tento program všechny kontejnery stejnými úlohami
+ * a každý výsledek vypíše jako jeden řádek JSON (JSON Lines), aby je CI
+ * mohlo porovnat s uloženým základem (baseline). Klíč "id" je pro stejné
+ * měření v každém běhu stejný. První řádek popisuje stroj a běh.
+ *
+ * Velikosti kontejnerů se odvozují od velikosti cache procesoru: zhruba
+ * polovina L1, polovina L2, polovina poslední úrovně (LLC) a desetinásobek
+ * LLC; počet prvků je odhadovaná paměť na prvek. Pro každou velikost
+ * a každé rozdělení klíčů (uniform, zipf s exponentem BENCH_ZIPF_S,
+ * sorted a anagram, tedy permutace stejných znaků, které dříve dávaly
+ * get_hash stejný hash) změří fáze:
+ *
+ *   build     vložení všech klíčů (sorted vzestupně, jinak náhodně)
+ *   read      BENCH_OPS operací, z toho 95 % hledání
+ *   write     BENCH_OPS operací, z toho 50 % vložení nebo smazání
+ *   walk      průchod všemi uzly stromu (jen stromy)
+ *   teardown  zrušení celého kontejneru
+ *
+ * Kontejnery jsou tabulka pevné velikosti (hashtable.c, jen do
+ * BENCH_FIXED_LOAD prvků na seznam), dynamická tabulka se zřetězením
+ * a s otevřeným adresováním, generický AVL strom s 64bitovými klíči
+ * (btree_gen.h) a přeložená varianta stromu se znakovými klíči (jen
+ * 256 klíčů, víc jich char nemá). Nakonec letter_count (exa.c) nad
+ * textem velikosti každého kroku.
+ *
+ * Každý řádek uvádí ns/op; fáze read a write navíc percentily latence
+ * jednotlivých operací z druhého průchodu, ve kterém se měří každá
+ * operace zvlášť (bez režie hodin). Kde to jádro dovolí, uvádí počet cache
+ * miss z perf_event_open (jen uživatelský prostor), jinak null.
+ *
+ * Klíče i pořadí operací závisí jen na semínku, běh je tedy opakovatelný.
+ *
+ * Překlad:  cc -O2 -pthread -I<adresář s hashtable.h, btree.h a stack.h> \
+ *               -DBENCH_TREE_NAME='"rec"' bench_suite.c hashtable.c hashtable_oa.c \
+ *               ht_hash.c pool.c btree_pool.c exa.c <soubor varianty stromu> \
+ *               <soubory zadání> -lm -o bench_suite
+ * Spuštění: ./bench_suite [strop velikosti v MiB, 0 = bez stropu] [semínko] > results.jsonl
+ */
+
+// syscall() for perf_event_open is not part of POSIX.
+#define _GNU_SOURCE
+
+#include "../btree.h"
+#include "btree_ext.h"
+#include "btree_gen.h"
+#include "hashtable.h"
+#include "hashtable_ext.h"
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#ifndef BENCH_TREE_NAME
+#define BENCH_TREE_NAME "bst"
+#endif
+
+// Operations of one read or write phase.
+#define BENCH_OPS (1u << 20)
+// Operations timed one by one for the percentiles.
+#define BENCH_SAMPLES (1u << 17)
+// Exponent of the Zipf distribution of the lookups.
+#define BENCH_ZIPF_S 0.99
+// The fixed table is measured only up to this many items per bucket.
+#define BENCH_FIXED_LOAD 16
+// Bytes reserved for one generated key.
+#define BENCH_KEY_LEN 24
+// Top bit of an operation in the stream marks a write.
+#define BENCH_WRITE (1u << 31)
+
+BST_GEN(bench_u64, uint64_t, int64_t, BST_GEN_CMP_NUM)
+
+void letter_count(bst_node_t **tree, char *input);
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t bench_rng = 1;
+
+static uint64_t bench_random(void) {
+    // xorshift64*, seeded from the command line.
+    bench_rng ^= bench_rng >> 12;
+    bench_rng ^= bench_rng << 25;
+    bench_rng ^= bench_rng >> 27;
+    return bench_rng * 0x2545F4914F6CDD1Dull;
+}
+
+static double bench_uniform(void) {
+    return (bench_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void *bench_alloc(size_t size) {
+    void *memory = malloc(size);
+    if (memory == NULL) {
+        fprintf(stderr, "bench_suite: out of memory\n");
+        exit(1);
+    }
+    return memory;
+}
+
+/*
+ * Počítadlo cache miss (perf_event_open), -1 pokud není k dispozici.
+ */
+static int bench_perf = -1;
+
+static void bench_perf_open(void) {
+#if defined(__linux__)
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    bench_perf = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+static void bench_perf_start(void) {
+#if defined(__linux__)
+    if (bench_perf >= 0) {
+        ioctl(bench_perf, PERF_EVENT_IOC_RESET, 0);
+        ioctl(bench_perf, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+/*
+ * Zastaví počítadlo a vrátí počet miss od bench_perf_start, nebo -1.
+ */
+static long long bench_perf_stop(void) {
+#if defined(__linux__)
+    uint64_t count;
+    if (bench_perf >= 0) {
+        ioctl(bench_perf, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(bench_perf, &count, sizeof(count)) == (ssize_t)sizeof(count)) {
+            return (long long)count;
+        }
+    }
+#endif
+    return -1;
+}
+
+/*
+ * Velikost cache podle sysconf, default pokud ji systém neuvádí.
+ */
+static size_t bench_cache(int name, size_t fallback) {
+    long size = sysconf(name);
+    return size > 0 ? (size_t)size : fallback;
+}
+
+// Percentiles reported for the timed phases, in per mille, and their names.
+static const int bench_permille[] = {500, 900, 990, 999};
+static const char *const bench_percentile_names[] = {"p50_ns", "p90_ns", "p99_ns", "p999_ns"};
+
+typedef struct bench_result {
+    const char *container;  // measured container
+    const char *keys;       // key distribution
+    const char *phase;      // build, read, write, walk, teardown or count
+    size_t count;           // items in the container (bytes for letter_count)
+    size_t footprint;       // estimated bytes of the container
+    size_t ops;             // operations timed
+    double ns;              // total time of the operations
+    long long misses;       // cache misses, -1 if unknown
+    bool latency;           // the latencies below are valid
+    double percentiles[sizeof(bench_permille) / sizeof(bench_permille[0])];
+    double max;             // slowest sampled operation
+} bench_result_t;
+
+static void bench_print(const bench_result_t *r) {
+    printf("{\"id\":\"%s/%s/%zu/%s\",\"container\":\"%s\",\"keys\":\"%s\",\"phase\":\"%s\",\"count\":%zu,"
+           "\"footprint\":%zu,\"ops\":%zu,\"ns_per_op\":%.3f",
+           r->container, r->keys, r->count, r->phase, r->container, r->keys, r->phase, r->count, r->footprint,
+           r->ops, r->ops ? r->ns / r->ops : 0.0);
+    for (size_t i = 0; i < sizeof(bench_permille) / sizeof(bench_permille[0]); i++) {
+        if (r->latency) {
+            printf(",\"%s\":%.1f", bench_percentile_names[i], r->percentiles[i]);
+        } else {
+            printf(",\"%s\":null", bench_percentile_names[i]);
+        }
+    }
+    r->latency ? printf(",\"max_ns\":%.1f", r->max) : printf(",\"max_ns\":null");
+    r->misses >= 0 ? printf(",\"cache_misses\":%lld}\n", r->misses) : printf(",\"cache_misses\":null}\n");
+    fflush(stdout);
+}
+
+/*
+ * Kontejner pod společným rozhraním: klíče jsou indexy 0..count-1 do pole
+ * řetězců (tabulky) nebo přímo čísla (stromy), pořadí indexů je pořadí
+ * klíčů.
+ */
+typedef struct bench_state {
+    char **keys;               // string key of every index
+    ht_table_t *fixed;         // table of hashtable.c
+    ht_dyn_table_t dyn;        // dynamic table
+    bench_u64_node_t *avl;     // generic tree
+    bst_node_t *bst;           // tree of the linked variant
+} bench_state_t;
+
+typedef struct bench_container {
+    const char *name;
+    size_t entry_bytes;        // estimated memory per item, key included
+    size_t max_count;          // largest measured size, 0 for no limit
+    bool string_keys;          // the container hashes the keys[] strings
+    void (*init)(bench_state_t *state);
+    void (*insert)(bench_state_t *state, size_t index);
+    bool (*search)(bench_state_t *state, size_t index);
+    void (*remove)(bench_state_t *state, size_t index);
+    size_t (*walk)(bench_state_t *state);  // NULL if the container has no traversal
+    void (*teardown)(bench_state_t *state);
+} bench_container_t;
+
+static void bench_fixed_init(bench_state_t *state) {
+    state->fixed = (ht_table_t *)bench_alloc(sizeof(ht_table_t));
+    ht_init(state->fixed);
+}
+
+static void bench_fixed_insert(bench_state_t *state, size_t index) {
+    ht_insert(state->fixed, state->keys[index], (float)index);
+}
+
+static bool bench_fixed_search(bench_state_t *state, size_t index) {
+    return ht_search(state->fixed, state->keys[index]) != NULL;
+}
+
+static void bench_fixed_remove(bench_state_t *state, size_t index) {
+    ht_delete(state->fixed, state->keys[index]);
+}
+
+static void bench_fixed_teardown(bench_state_t *state) {
+    ht_delete_all(state->fixed);
+    free(state->fixed);
+}
+
+static void bench_chained_init(bench_state_t *state) {
+    ht_dyn_init(&state->dyn);
+}
+
+static void bench_open_init(bench_state_t *state) {
+    ht_dyn_config_t config = {ht_hash_wy, HT_HASH_DEFAULT_SEED, HT_BACKEND_OPEN, false};
+    ht_dyn_init_config(&state->dyn, &config);
+}
+
+static void bench_dyn_insert(bench_state_t *state, size_t index) {
+    ht_dyn_insert(&state->dyn, state->keys[index], (float)index);
+}
+
+static bool bench_dyn_search(bench_state_t *state, size_t index) {
+    return ht_dyn_search(&state->dyn, state->keys[index]) != NULL;
+}
+
+static void bench_dyn_remove(bench_state_t *state, size_t index) {
+    ht_dyn_delete(&state->dyn, state->keys[index]);
+}
+
+static void bench_dyn_teardown(bench_state_t *state) {
+    ht_dyn_delete_all(&state->dyn);
+}
+
+static void bench_avl_init(bench_state_t *state) {
+    bench_u64_init(&state->avl);
+}
+
+static void bench_avl_insert(bench_state_t *state, size_t index) {
+    bench_u64_insert(&state->avl, index, (int64_t)index);
+}
+
+static bool bench_avl_search(bench_state_t *state, size_t index) {
+    int64_t value;
+    return bench_u64_search(state->avl, index, &value);
+}
+
+static void bench_avl_remove(bench_state_t *state, size_t index) {
+    bench_u64_delete(&state->avl, index);
+}
+
+static bool bench_avl_count(bench_u64_node_t *node, void *context) {
+    (void)node;
+    (*(size_t *)context)++;
+    return true;
+}
+
+static size_t bench_avl_walk(bench_state_t *state) {
+    size_t count = 0;
+    bench_u64_range(state->avl, 0, UINT64_MAX, bench_avl_count, &count);
+    return count;
+}
+
+static void bench_avl_teardown(bench_state_t *state) {
+    bench_u64_dispose(&state->avl);
+}
+
+static void bench_bst_init(bench_state_t *state) {
+    bst_init(&state->bst);
+}
+
+// Index 0..255 in key order.
+static char bench_bst_key(size_t index) {
+    return (char)((int)index + CHAR_MIN);
+}
+
+static void bench_bst_insert(bench_state_t *state, size_t index) {
+    bst_insert(&state->bst, bench_bst_key(index), (int)index);
+}
+
+static bool bench_bst_search(bench_state_t *state, size_t index) {
+    int value;
+    return bst_search(state->bst, bench_bst_key(index), &value);
+}
+
+static void bench_bst_remove(bench_state_t *state, size_t index) {
+    bst_delete(&state->bst, bench_bst_key(index));
+}
+
+static bool bench_bst_count(bst_node_t *node, void *context) {
+    (void)node;
+    (*(size_t *)context)++;
+    return true;
+}
+
+static size_t bench_bst_walk(bench_state_t *state) {
+    size_t count = 0;
+    bst_inorder_visit(state->bst, bench_bst_count, &count);
+    return count;
+}
+
+static void bench_bst_teardown(bench_state_t *state) {
+    bst_dispose(&state->bst);
+}
+
+/*
+ * Pořadí vkládání a proud operací pro jedno rozdělení klíčů.
+ */
+typedef struct bench_keys {
+    const char *name;
+    bool sorted;               // build in key order and scan sequentially
+    bool zipf;                 // lookups follow a Zipf distribution over a random ranking
+    bool anagram;              // string keys are permutations of the same letters
+} bench_keys_t;
+
+static const bench_keys_t bench_distributions[] = {
+    {"uniform", false, false, false},
+    {"zipf", false, true, false},
+    {"sorted", true, false, false},
+    {"anagram", false, false, true},
+};
+
+/*
+ * Klíč index: buď "key:<index>", nebo index-tá permutace znaků letters
+ * (Lehmerův kód), takže všechny klíče mají stejné znaky.
+ */
+static void bench_key(char *key, size_t index, bool anagram) {
+    static const char letters[] = "abcdefghijklmn";
+    if (!anagram) {
+        snprintf(key, BENCH_KEY_LEN, "key:%zu", index);
+        return;
+    }
+    char pool[sizeof(letters)];
+    memcpy(pool, letters, sizeof(letters));
+    size_t left = sizeof(letters) - 1;
+    for (size_t i = 0; i < sizeof(letters) - 1; i++) {
+        // Pick digit i of index in the factorial number system.
+        size_t pick = index % left;
+        index /= left;
+        key[i] = pool[pick];
+        memmove(pool + pick, pool + pick + 1, left - pick);
+        left--;
+    }
+    key[sizeof(letters) - 1] = '\0';
+}
+
+static void bench_shuffle(size_t *order, size_t count) {
+    for (size_t i = count; i > 1; i--) {
+        size_t j = bench_random() % i;
+        size_t tmp = order[i - 1];
+        order[i - 1] = order[j];
+        order[j] = tmp;
+    }
+}
+
+/*
+ * Rank z Zipfova rozdělení na 0..count-1 inverzí spojité aproximace
+ * distribuční funkce; stačí na tvar rozdělení a je O(1).
+ */
+static size_t bench_zipf(size_t count) {
+    double exponent = 1.0 - BENCH_ZIPF_S;
+    double rank = pow((pow((double)count + 1, exponent) - 1) * bench_uniform() + 1, 1.0 / exponent) - 1;
+    return rank < (double)count ? (size_t)rank : count - 1;
+}
+
+/*
+ * Proud BENCH_OPS operací: index klíče, s bitem BENCH_WRITE u zápisu
+ * (writes promile operací). Zipf volí rank a permutace ranking z něj
+ * udělá klíč, aby oblíbené klíče neležely vedle sebe.
+ */
+static void bench_stream(uint32_t *stream, const bench_keys_t *keys, const size_t *ranking, size_t count,
+                         unsigned writes) {
+    for (size_t i = 0; i < BENCH_OPS; i++) {
+        size_t index = keys->sorted ? i % count : keys->zipf ? ranking[bench_zipf(count)] : bench_random() % count;
+        stream[i] = (uint32_t)index | (bench_random() % 1000 < writes ? BENCH_WRITE : 0);
+    }
+}
+
+static volatile size_t bench_sink;
+
+/*
+ * Jedna operace proudu: hledání, nebo přepnutí přítomnosti klíče.
+ */
+static inline void bench_op(const bench_container_t *c, bench_state_t *state, uint32_t op, uint8_t *present) {
+    size_t index = op & ~BENCH_WRITE;
+    if (op & BENCH_WRITE) {
+        present[index] ? c->remove(state, index) : c->insert(state, index);
+        present[index] ^= 1;
+    } else {
+        bench_sink += c->search(state, index);
+    }
+}
+
+static int bench_compare(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Cost of one bench_now() pair, subtracted from the sampled latencies.
+static double bench_clock_cost;
+
+/*
+ * Fáze read nebo write: nejdřív celý proud najednou (ns/op a cache miss),
+ * pak prvních BENCH_SAMPLES operací znovu, každou měřenou zvlášť.
+ */
+static void bench_mix(const bench_container_t *c, bench_state_t *state, bench_result_t *r, const uint32_t *stream,
+                      uint8_t *present, double *samples) {
+    bench_perf_start();
+    double start = bench_now();
+    for (size_t i = 0; i < BENCH_OPS; i++) {
+        bench_op(c, state, stream[i], present);
+    }
+    r->ns = bench_now() - start;
+    r->misses = bench_perf_stop();
+    r->ops = BENCH_OPS;
+
+    for (size_t i = 0; i < BENCH_SAMPLES; i++) {
+        double begin = bench_now();
+        bench_op(c, state, stream[i], present);
+        double latency = bench_now() - begin - bench_clock_cost;
+        samples[i] = latency > 0 ? latency : 0;
+    }
+    qsort(samples, BENCH_SAMPLES, sizeof(double), bench_compare);
+    for (size_t i = 0; i < sizeof(bench_permille) / sizeof(bench_permille[0]); i++) {
+        r->percentiles[i] = samples[(size_t)bench_permille[i] * (BENCH_SAMPLES - 1) / 1000];
+    }
+    r->max = samples[BENCH_SAMPLES - 1];
+    r->latency = true;
+    bench_print(r);
+    r->latency = false;
+}
+
+/*
+ * Všechny fáze jednoho kontejneru s count prvky a rozdělením keys.
+ */
+static void bench_container(const bench_container_t *c, const bench_keys_t *keys, size_t count, double *samples) {
+    bench_state_t state;
+    memset(&state, 0, sizeof(state));
+    size_t *order = (size_t *)bench_alloc(count * sizeof(size_t));
+    size_t *ranking = (size_t *)bench_alloc(count * sizeof(size_t));
+    uint8_t *present = (uint8_t *)bench_alloc(count);
+    uint32_t *stream = (uint32_t *)bench_alloc(BENCH_OPS * sizeof(uint32_t));
+    char *storage = NULL;
+    if (c->string_keys) {
+        state.keys = (char **)bench_alloc(count * sizeof(char *));
+        storage = (char *)bench_alloc(count * BENCH_KEY_LEN);
+        for (size_t i = 0; i < count; i++) {
+            state.keys[i] = storage + i * BENCH_KEY_LEN;
+            bench_key(state.keys[i], i, keys->anagram);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        order[i] = i;
+        ranking[i] = i;
+        present[i] = 1;
+    }
+    if (!keys->sorted) {
+        bench_shuffle(order, count);
+    }
+    bench_shuffle(ranking, count);
+
+    bench_result_t r = {.container = c->name, .keys = keys->name, .count = count,
+                        .footprint = count * c->entry_bytes};
+    c->init(&state);
+    r.phase = "build";
+    r.ops = count;
+    bench_perf_start();
+    double start = bench_now();
+    for (size_t i = 0; i < count; i++) {
+        c->insert(&state, order[i]);
+    }
+    r.ns = bench_now() - start;
+    r.misses = bench_perf_stop();
+    bench_print(&r);
+
+    r.phase = "read";
+    bench_stream(stream, keys, ranking, count, 50);
+    bench_mix(c, &state, &r, stream, present, samples);
+    r.phase = "write";
+    bench_stream(stream, keys, ranking, count, 500);
+    bench_mix(c, &state, &r, stream, present, samples);
+
+    if (c->walk != NULL) {
+        r.phase = "walk";
+        bench_perf_start();
+        start = bench_now();
+        r.ops = c->walk(&state);
+        r.ns = bench_now() - start;
+        r.misses = bench_perf_stop();
+        bench_print(&r);
+    }
+
+    r.phase = "teardown";
+    r.ops = 0;
+    for (size_t i = 0; i < count; i++) {
+        r.ops += present[i];
+    }
+    bench_perf_start();
+    start = bench_now();
+    c->teardown(&state);
+    r.ns = bench_now() - start;
+    r.misses = bench_perf_stop();
+    bench_print(&r);
+
+    free(state.keys);
+    free(storage);
+    free(order);
+    free(ranking);
+    free(present);
+    free(stream);
+}
+
+/*
+ * letter_count nad textem o size bajtech.
+ */
+static void bench_letters(size_t size) {
+    static const char alphabet[] = "eeettaoinshrdlucmfwypvbgkjqxzETAOINS      .,;!?-_0123456789\n";
+    char *input = (char *)bench_alloc(size + 1);
+    for (size_t i = 0; i < size; i++) {
+        input[i] = alphabet[bench_random() % (sizeof(alphabet) - 1)];
+    }
+    input[size] = '\0';
+
+    bench_result_t r = {.container = "letter_count", .keys = "text", .phase = "count", .count = size,
+                        .footprint = size, .ops = size};
+    bst_node_t *tree;
+    bench_perf_start();
+    double start = bench_now();
+    letter_count(&tree, input);
+    r.ns = bench_now() - start;
+    r.misses = bench_perf_stop();
+    bench_print(&r);
+    bst_dispose(&tree);
+    free(input);
+}
+
+int main(int argc, char *argv[]) {
+    size_t cap = argc > 1 ? strtoul(argv[1], NULL, 10) << 20 : 0;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+    bench_rng = seed != 0 ? seed : 1;
+
+    size_t l1 = bench_cache(_SC_LEVEL1_DCACHE_SIZE, 32 << 10);
+    size_t l2 = bench_cache(_SC_LEVEL2_CACHE_SIZE, 1 << 20);
+    size_t llc = bench_cache(_SC_LEVEL3_CACHE_SIZE, l2);
+    size_t footprints[] = {l1 / 2, l2 / 2, llc / 2, llc * 10};
+
+    bench_clock_cost = 1e9;
+    for (int i = 0; i < 1000; i++) {
+        double begin = bench_now();
+        double cost = bench_now() - begin;
+        bench_clock_cost = cost < bench_clock_cost ? cost : bench_clock_cost;
+    }
+    bench_perf_open();
+    printf("{\"suite\":\"bench_suite\",\"format\":1,\"seed\":%llu,\"tree\":\"%s\",\"l1d\":%zu,\"l2\":%zu,"
+           "\"llc\":%zu,\"clock_ns\":%.1f,\"cache_misses\":%s}\n",
+           (unsigned long long)seed, BENCH_TREE_NAME, l1, l2, llc, bench_clock_cost,
+           bench_perf >= 0 ? "true" : "false");
+
+    const bench_container_t containers[] = {
+        {"ht", sizeof(ht_item_t) + BENCH_KEY_LEN, (size_t)HT_SIZE * BENCH_FIXED_LOAD, true, bench_fixed_init,
+         bench_fixed_insert, bench_fixed_search, bench_fixed_remove, NULL, bench_fixed_teardown},
+        {"ht_dyn_chained", sizeof(ht_dyn_item_t) + sizeof(void *) + BENCH_KEY_LEN, 0, true, bench_chained_init,
+         bench_dyn_insert, bench_dyn_search, bench_dyn_remove, NULL, bench_dyn_teardown},
+        {"ht_dyn_open", sizeof(ht_dyn_entry_t) * 8 / 7 + 1 + BENCH_KEY_LEN, 0, true, bench_open_init,
+         bench_dyn_insert, bench_dyn_search, bench_dyn_remove, NULL, bench_dyn_teardown},
+        {"avl_u64", sizeof(bench_u64_node_t), 0, false, bench_avl_init, bench_avl_insert, bench_avl_search,
+         bench_avl_remove, bench_avl_walk, bench_avl_teardown},
+    };
+    const bench_container_t bst = {BENCH_TREE_NAME, bst_node_size, 256, false, bench_bst_init, bench_bst_insert,
+                                   bench_bst_search, bench_bst_remove, bench_bst_walk, bench_bst_teardown};
+
+    double *samples = (double *)bench_alloc(BENCH_SAMPLES * sizeof(double));
+    for (size_t d = 0; d < sizeof(bench_distributions) / sizeof(bench_distributions[0]); d++) {
+        const bench_keys_t *keys = &bench_distributions[d];
+        for (size_t s = 0; s < sizeof(footprints) / sizeof(footprints[0]); s++) {
+            if (cap != 0 && footprints[s] > cap) {
+                continue;
+            }
+            for (size_t i = 0; i < sizeof(containers) / sizeof(containers[0]); i++) {
+                const bench_container_t *c = &containers[i];
+                size_t count = footprints[s] / c->entry_bytes;
+                // Anagrams only matter to hash functions.
+                if ((c->max_count != 0 && count > c->max_count) || (keys->anagram && !c->string_keys)) {
+                    continue;
+                }
+                bench_container(c, keys, count, samples);
+            }
+        }
+        // All 256 char keys fit into L1, so the char-keyed tree is measured at one size.
+        if (!keys->anagram) {
+            bench_container(&bst, keys, bst.max_count, samples);
+        }
+    }
+    for (size_t s = 0; s < sizeof(footprints) / sizeof(footprints[0]); s++) {
+        if (cap == 0 || footprints[s] <= cap) {
+            bench_letters(footprints[s]);
+        }
+    }
+    free(samples);
+    return 0;
+}
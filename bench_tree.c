@@ -0,0 +1,329 @@
+/*
+ * Měření výkonu vyhledávání v binárním vyhledávacím stromu
+ *
+ * Program se překládá vždy s jednou variantou stromu (btree.c, btree_iter.c
+ * nebo btree_avl.c), aby bylo možné varianty porovnat. Pro n různých klíčů
+ * postaví strom jednou v náhodném a jednou v seřazeném pořadí vkládání
+ * a měří dobu bst_search nad náhodnými klíči. Doba hledání má růst s výškou
+ * stromu, ne s počtem uzlů.
+ *
+ * Průchody pre/in/postorder se zásobníkem (z přeložené varianty) porovná
+ * s průchody bez zásobníku (btree_morris.c) a s průchody s funkcí visit
+ * (bez pole uzlů) na náhodném a na zdegenerovaném stromu; průchody se
+ * zásobníkem se na stromu hlubším než MAXSTACK přeskočí.
+ *
+ * Rušení stromu (bst_dispose) měří na [počet uzlů] uzlech ve tvaru řetězce
+ * levých potomků (nejhlubší možný strom) a úplného stromu; pro srovnání
+ * i uvolnění stejného stromu najednou funkcí pool_release.
+ *
+ * Pro velké indexy s 64bitovými klíči pak porovná generický strom
+ * (btree_gen.h) s B+ stromem (bplustree.c) při [počet klíčů] náhodných
+ * klíčích a s jeho zmrazenou kopií v rozložení Eytzinger (name_freeze).
+ *
+ * Překlad:  cc -O2 -I<adresář s btree.h a stack.h> -DBENCH_TREE_NAME='"rec"' \
+ *               bench_tree.c btree_iter.c btree_pool.c btree_morris.c pool.c bplustree.c \
+ *               <soubory zadání> \
+ *               -o bench_tree
+ * Spuštění: ./bench_tree [počet hledání] [počet klíčů] [počet uzlů]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../btree.h"
+#include "bplustree.h"
+#include "btree_ext.h"
+#include "btree_gen.h"
+#include "stack.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef BENCH_TREE_NAME
+#define BENCH_TREE_NAME "bst"
+#endif
+
+// Distinct char keys available.
+#define BENCH_TREE_MAX_KEYS 256
+// Full traversals per measurement.
+#define BENCH_TREE_WALKS 20000
+
+BST_GEN(bench_u64, uint64_t, int64_t, BST_GEN_CMP_NUM)
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int bench_height(bst_node_t *tree) {
+    if (tree == NULL) {
+        return 0;
+    }
+    int left = bench_height(tree->left);
+    int right = bench_height(tree->right);
+    return (left > right ? left : right) + 1;
+}
+
+/*
+ * Postaví strom z prvních n klíčů pole keys, změří lookups hledání
+ * náhodných vložených klíčů a strom zruší.
+ */
+static void bench_lookups(const char *shape, const char *keys, size_t n, size_t lookups) {
+    bst_node_t *tree;
+    bst_init(&tree);
+    for (size_t i = 0; i < n; i++) {
+        bst_insert(&tree, keys[i], (int)i);
+    }
+
+    // Pick the probe keys up front so the timed loop only searches.
+    char *probes = (char *)malloc(lookups);
+    if (probes == NULL) {
+        fprintf(stderr, "bench_tree: out of memory\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < lookups; i++) {
+        probes[i] = keys[(size_t)rand() % n];
+    }
+
+    // Guards against the compiler dropping the lookups.
+    volatile int sink = 0;
+    int value = 0;
+    double start = bench_now();
+    for (size_t i = 0; i < lookups; i++) {
+        sink += bst_search(tree, probes[i], &value);
+    }
+    double elapsed = bench_now() - start;
+    (void)sink;
+
+    printf("%-10s %-6s %4zu keys  height %3d %8.1f ns/op\n", BENCH_TREE_NAME, shape, n, bench_height(tree),
+           elapsed / lookups);
+    free(probes);
+    bst_dispose(&tree);
+}
+
+typedef void (*bench_walk_t)(bst_node_t *tree, bst_items_t *items);
+
+/*
+ * Změří BENCH_TREE_WALKS průchodů funkcí walk; pole uzlů se mezi průchody
+ * jen vyprázdní, aby se neměřilo jeho zvětšování.
+ */
+static void bench_walk(const char *shape, const char *name, bench_walk_t walk, bst_node_t *tree, size_t n) {
+    bst_items_t items = {NULL, 0, 0};
+    double start = bench_now();
+    for (int i = 0; i < BENCH_TREE_WALKS; i++) {
+        items.size = 0;
+        walk(tree, &items);
+    }
+    double elapsed = bench_now() - start;
+    printf("%-10s %-6s %-15s %8.2f ns/node\n", BENCH_TREE_NAME, shape, name, elapsed / BENCH_TREE_WALKS / n);
+    free(items.nodes);
+}
+
+typedef bool (*bench_visit_t)(bst_node_t *tree, bst_visitor_t visit, void *context);
+
+static bool bench_sum(bst_node_t *node, void *context) {
+    *(long *)context += node->value;
+    return true;
+}
+
+/*
+ * Změří BENCH_TREE_WALKS průchodů funkcí walk s funkcí visit, která jen
+ * sčítá hodnoty; nic se nealokuje ani neukládá.
+ */
+static void bench_visit(const char *shape, const char *name, bench_visit_t walk, bst_node_t *tree, size_t n) {
+    volatile long sink = 0;
+    double start = bench_now();
+    for (int i = 0; i < BENCH_TREE_WALKS; i++) {
+        long sum = 0;
+        walk(tree, bench_sum, &sum);
+        sink += sum;
+    }
+    double elapsed = bench_now() - start;
+    (void)sink;
+    printf("%-10s %-6s %-15s %8.2f ns/node\n", BENCH_TREE_NAME, shape, name, elapsed / BENCH_TREE_WALKS / n);
+}
+
+static void bench_walks(const char *shape, const char *keys, size_t n) {
+    bst_node_t *tree;
+    bst_init(&tree);
+    for (size_t i = 0; i < n; i++) {
+        bst_insert(&tree, keys[i], (int)i);
+    }
+    // The stack-based walks keep up to one node per level on a MAXSTACK-deep stack.
+    if (bench_height(tree) < MAXSTACK) {
+        bench_walk(shape, "preorder", bst_preorder, tree, n);
+        bench_walk(shape, "inorder", bst_inorder, tree, n);
+        bench_walk(shape, "postorder", bst_postorder, tree, n);
+        bench_visit(shape, "preorder-visit", bst_preorder_visit, tree, n);
+        bench_visit(shape, "inorder-visit", bst_inorder_visit, tree, n);
+        bench_visit(shape, "postorder-visit", bst_postorder_visit, tree, n);
+    }
+    bench_walk(shape, "preorder-morris", bst_preorder_morris, tree, n);
+    bench_walk(shape, "inorder-morris", bst_inorder_morris, tree, n);
+    bench_walk(shape, "postorder-morris", bst_postorder_morris, tree, n);
+    bst_dispose(&tree);
+}
+
+/*
+ * Uzel pro test rušení; klíče nehrají roli, stromy se spojují přímo.
+ */
+static bst_node_t *bench_node(void) {
+    bst_node_t *node = bst_node_alloc_size(bst_node_size);
+    if (node == NULL) {
+        fprintf(stderr, "bench_tree: out of memory\n");
+        exit(1);
+    }
+    node->key = 0;
+    node->value = 0;
+    node->left = NULL;
+    node->right = NULL;
+    return node;
+}
+
+static bst_node_t *bench_complete(size_t count) {
+    if (count == 0) {
+        return NULL;
+    }
+    bst_node_t *node = bench_node();
+    node->left = bench_complete((count - 1) / 2);
+    node->right = bench_complete(count - 1 - (count - 1) / 2);
+    return node;
+}
+
+static bst_node_t *bench_chain(size_t count) {
+    bst_node_t *tree = NULL;
+    for (size_t i = 0; i < count; i++) {
+        bst_node_t *node = bench_node();
+        node->left = tree;
+        tree = node;
+    }
+    return tree;
+}
+
+static void bench_teardown(size_t count) {
+    const struct {
+        const char *shape;
+        bst_node_t *(*build)(size_t count);
+    } shapes[] = {{"chain", bench_chain}, {"complete", bench_complete}};
+
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+        bst_node_t *tree = shapes[i].build(count);
+        double start = bench_now();
+        bst_dispose(&tree);
+        printf("%-10s %-8s %9zu nodes dispose      %6.1f ns/node\n", BENCH_TREE_NAME, shapes[i].shape, count,
+               (bench_now() - start) / count);
+
+        pool_t pool;
+        pool_init(&pool, bst_node_size);
+        bst_use_pool(&pool);
+        tree = shapes[i].build(count);
+        start = bench_now();
+        pool_release(&pool);
+        printf("%-10s %-8s %9zu nodes pool_release %6.1f ns/node\n", BENCH_TREE_NAME, shapes[i].shape, count,
+               (bench_now() - start) / count);
+        bst_use_pool(NULL);
+    }
+}
+
+static uint64_t bench_mix(uint64_t x) {
+    // splitmix64 finalizer, a bijection, so distinct inputs give distinct keys.
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+static void bench_index_report(const char *engine, const char *op, size_t count, double ns) {
+    printf("%-10s %-6s %9zu keys %8.1f ns/op\n", engine, op, count, ns / count);
+}
+
+/*
+ * Velký index: count náhodných 64bitových klíčů v binárním stromu
+ * a v B+ stromu, vložení a hledání v náhodném pořadí.
+ */
+static void bench_index(size_t count) {
+    bench_u64_node_t *bst;
+    bpt_tree_t bpt;
+    bench_u64_init(&bst);
+    bpt_init(&bpt);
+    volatile int64_t sink = 0;
+    int64_t value;
+
+    double start = bench_now();
+    for (size_t i = 0; i < count; i++) {
+        bench_u64_insert(&bst, bench_mix(i), (int64_t)i);
+    }
+    bench_index_report("avl", "insert", count, bench_now() - start);
+    start = bench_now();
+    for (size_t i = 0; i < count; i++) {
+        bpt_insert(&bpt, (bpt_key_t)bench_mix(i), (int64_t)i);
+    }
+    bench_index_report("bplus", "insert", count, bench_now() - start);
+
+    // Probe in a different order than the inserts.
+    start = bench_now();
+    for (size_t i = 0; i < count; i++) {
+        bench_u64_search(bst, bench_mix(bench_mix(i) % count), &value);
+        sink += value;
+    }
+    bench_index_report("avl", "search", count, bench_now() - start);
+    start = bench_now();
+    for (size_t i = 0; i < count; i++) {
+        bpt_search(&bpt, (bpt_key_t)bench_mix(bench_mix(i) % count), &value);
+        sink += value;
+    }
+    bench_index_report("bplus", "search", count, bench_now() - start);
+
+    bench_u64_frozen_t frozen;
+    if (bench_u64_freeze(bst, &frozen)) {
+        start = bench_now();
+        for (size_t i = 0; i < count; i++) {
+            bench_u64_frozen_search(&frozen, bench_mix(bench_mix(i) % count), &value);
+            sink += value;
+        }
+        bench_index_report("frozen", "search", count, bench_now() - start);
+        bench_u64_frozen_dispose(&frozen);
+    }
+    (void)sink;
+
+    bench_u64_dispose(&bst);
+    bpt_dispose(&bpt);
+}
+
+int main(int argc, char *argv[]) {
+    size_t lookups = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t index_keys = argc > 2 ? strtoul(argv[2], NULL, 10) : 4000000;
+    size_t teardown_nodes = argc > 3 ? strtoul(argv[3], NULL, 10) : 10000000;
+    if (lookups == 0 || index_keys == 0 || teardown_nodes == 0) {
+        fprintf(stderr, "usage: %s [lookup count] [index key count] [teardown node count]\n", argv[0]);
+        return 1;
+    }
+
+    char sorted[BENCH_TREE_MAX_KEYS], shuffled[BENCH_TREE_MAX_KEYS];
+    srand(1);
+    for (size_t n = 16; n <= BENCH_TREE_MAX_KEYS; n *= 2) {
+        for (size_t i = 0; i < n; i++) {
+            sorted[i] = (char)(i - n / 2);
+            shuffled[i] = sorted[i];
+        }
+        for (size_t i = n - 1; i > 0; i--) {
+            size_t j = (size_t)rand() % (i + 1);
+            char tmp = shuffled[i];
+            shuffled[i] = shuffled[j];
+            shuffled[j] = tmp;
+        }
+        bench_lookups("random", shuffled, n, lookups);
+        bench_lookups("sorted", sorted, n, lookups);
+    }
+    // sorted/shuffled now hold all BENCH_TREE_MAX_KEYS keys; the short
+    // sorted prefix is a skewed tree that the stack-based walks can still do.
+    bench_walks("random", shuffled, BENCH_TREE_MAX_KEYS);
+    bench_walks("sorted", sorted, BENCH_TREE_MAX_KEYS);
+    bench_walks("skewed", sorted, MAXSTACK - 1 < BENCH_TREE_MAX_KEYS ? MAXSTACK - 1 : BENCH_TREE_MAX_KEYS);
+
+    bench_teardown(teardown_nodes);
+    bench_index(index_keys);
+    return 0;
+}
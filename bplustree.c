@@ -0,0 +1,441 @@
+/*
+ * B+ strom
+ *
+ * Vkládání i mazání postupují od kořene dolů a uzly upravují předem:
+ * plný potomek se rozdělí ještě před sestupem do něj a potomek s minimem
+ * klíčů si před sestupem vypůjčí klíč od souseda nebo se s ním sloučí.
+ * Žádná operace se tedy nemusí vracet nahoru a neúspěšná alokace při
+ * dělení nechá strom v platném stavu.
+ *
+ * Oddělovací klíče vnitřních uzlů se při mazání nepřepisují; platí jen, že
+ * levý podstrom má klíče menší a pravý větší nebo rovné oddělovači.
+ */
+
+#include "bplustree.h"
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(sizeof(bpt_leaf_t) <= BPT_NODE_SIZE, "leaf does not fit BPT_NODE_SIZE");
+_Static_assert(sizeof(bpt_inner_t) <= BPT_NODE_SIZE, "inner node does not fit BPT_NODE_SIZE");
+
+// Fewest keys a non-root node may be left with.
+#define BPT_LEAF_MIN (BPT_LEAF_KEYS / 2)
+#define BPT_INNER_MIN (BPT_INNER_KEYS / 2)
+// Nodes start on a cache line boundary.
+#define BPT_ALIGN 64
+
+/*
+ * Počet klíčů v seřazeném poli keys délky n, které jsou menší než key
+ * (strict) nebo menší nebo rovné key (!strict). Binární vyhledávání bez
+ * podmíněných skoků: porovnání se přeloží na podmíněný přesun, takže
+ * procesor nemusí předvídat výsledek.
+ */
+static inline uint32_t bpt_rank(const bpt_key_t *keys, uint32_t n, bpt_key_t key, bool strict) {
+    const bpt_key_t *base = keys;
+    if (n == 0) {
+        return 0;
+    }
+    while (n > 1) {
+        uint32_t half = n / 2;
+        bool right = strict ? base[half] < key : base[half] <= key;
+        base += right ? half : 0;
+        n -= half;
+    }
+    return (uint32_t)(base - keys) + (strict ? *base < key : *base <= key);
+}
+
+static inline bpt_leaf_t *bpt_as_leaf(bpt_node_t *node) {
+    return (bpt_leaf_t *)node;
+}
+
+static inline bpt_inner_t *bpt_as_inner(bpt_node_t *node) {
+    return (bpt_inner_t *)node;
+}
+
+static bpt_node_t *bpt_alloc(bool leaf) {
+    bpt_node_t *node = (bpt_node_t *)aligned_alloc(BPT_ALIGN, BPT_NODE_SIZE);
+    if (node != NULL) {
+        node->count = 0;
+        node->leaf = leaf;
+        if (leaf) {
+            bpt_as_leaf(node)->next = NULL;
+        }
+    }
+    return node;
+}
+
+/*
+ * Najde list, do kterého patří klíč key.
+ */
+static const bpt_leaf_t *bpt_find_leaf(const bpt_node_t *node, bpt_key_t key) {
+    while (!node->leaf) {
+        const bpt_inner_t *inner = (const bpt_inner_t *)node;
+        node = inner->children[bpt_rank(inner->keys, node->count, key, false)];
+    }
+    return (const bpt_leaf_t *)node;
+}
+
+/*
+ * Inicializace stromu.
+ */
+void bpt_init(bpt_tree_t *tree) {
+    tree->root = NULL;
+    tree->count = 0;
+    tree->height = 0;
+}
+
+/*
+ * Vyhledání klíče.
+ *
+ * V případě úspěchu vrátí funkce hodnotu true a do proměnné value zapíše
+ * hodnotu daného klíče. V opačném případě vrátí false a value nemění.
+ */
+bool bpt_search(const bpt_tree_t *tree, bpt_key_t key, bpt_value_t *value) {
+    if (tree->root == NULL) {
+        return false;
+    }
+    const bpt_leaf_t *leaf = bpt_find_leaf(tree->root, key);
+    uint32_t pos = bpt_rank(leaf->keys, leaf->node.count, key, true);
+    if (pos < leaf->node.count && leaf->keys[pos] == key) {
+        *value = leaf->values[pos];
+        return true;
+    }
+    return false;
+}
+
+/*
+ * Rozdělí plného potomka parent->children[index] na dva a oddělovací klíč
+ * vloží do parent, který plný není. Vrací false při nedostatku paměti;
+ * strom pak zůstane beze změny.
+ */
+static bool bpt_split_child(bpt_inner_t *parent, uint32_t index) {
+    bpt_node_t *child = parent->children[index];
+    bpt_node_t *sibling = bpt_alloc(child->leaf);
+    if (sibling == NULL) {
+        return false;
+    }
+    bpt_key_t separator;
+
+    if (child->leaf) {
+        // The right half moves over; its first key is copied up as the separator.
+        bpt_leaf_t *left = bpt_as_leaf(child), *right = bpt_as_leaf(sibling);
+        uint32_t keep = (uint32_t)(BPT_LEAF_KEYS + 1) / 2;
+        uint32_t moved = child->count - keep;
+        memcpy(right->keys, left->keys + keep, moved * sizeof(bpt_key_t));
+        memcpy(right->values, left->values + keep, moved * sizeof(bpt_value_t));
+        right->node.count = moved;
+        left->node.count = keep;
+        right->next = left->next;
+        left->next = right;
+        separator = right->keys[0];
+    } else {
+        // The middle key moves up and belongs to neither half.
+        bpt_inner_t *left = bpt_as_inner(child), *right = bpt_as_inner(sibling);
+        uint32_t keep = child->count / 2;
+        uint32_t moved = child->count - keep - 1;
+        separator = left->keys[keep];
+        memcpy(right->keys, left->keys + keep + 1, moved * sizeof(bpt_key_t));
+        memcpy(right->children, left->children + keep + 1, (moved + 1) * sizeof(bpt_node_t *));
+        right->node.count = moved;
+        left->node.count = keep;
+    }
+
+    uint32_t count = parent->node.count;
+    memmove(parent->keys + index + 1, parent->keys + index, (count - index) * sizeof(bpt_key_t));
+    memmove(parent->children + index + 2, parent->children + index + 1, (count - index) * sizeof(bpt_node_t *));
+    parent->keys[index] = separator;
+    parent->children[index + 1] = sibling;
+    parent->node.count = count + 1;
+    return true;
+}
+
+static inline bool bpt_full(const bpt_node_t *node) {
+    return node->count == (node->leaf ? BPT_LEAF_KEYS : BPT_INNER_KEYS);
+}
+
+/*
+ * Vložení klíče.
+ *
+ * Pokud klíč ve stromu už je, nahradí jeho hodnotu. Vrací false při
+ * nedostatku paměti; klíč pak vložen není, strom ale zůstane platný.
+ */
+bool bpt_insert(bpt_tree_t *tree, bpt_key_t key, bpt_value_t value) {
+    if (tree->root == NULL) {
+        tree->root = bpt_alloc(true);
+        if (tree->root == NULL) {
+            return false;
+        }
+        tree->height = 1;
+    }
+
+    // A full root is split under a new root, the only place where the tree grows.
+    if (bpt_full(tree->root)) {
+        bpt_inner_t *root = bpt_as_inner(bpt_alloc(false));
+        if (root == NULL) {
+            return false;
+        }
+        root->children[0] = tree->root;
+        if (!bpt_split_child(root, 0)) {
+            free(root);
+            return false;
+        }
+        tree->root = &root->node;
+        tree->height++;
+    }
+
+    bpt_node_t *node = tree->root;
+    while (!node->leaf) {
+        bpt_inner_t *inner = bpt_as_inner(node);
+        uint32_t index = bpt_rank(inner->keys, node->count, key, false);
+        if (bpt_full(inner->children[index])) {
+            if (!bpt_split_child(inner, index)) {
+                return false;
+            }
+            // The key may belong to the new right half.
+            index += key >= inner->keys[index];
+        }
+        node = inner->children[index];
+    }
+
+    bpt_leaf_t *leaf = bpt_as_leaf(node);
+    uint32_t count = node->count;
+    uint32_t pos = bpt_rank(leaf->keys, count, key, true);
+    if (pos < count && leaf->keys[pos] == key) {
+        leaf->values[pos] = value;
+        return true;
+    }
+    memmove(leaf->keys + pos + 1, leaf->keys + pos, (count - pos) * sizeof(bpt_key_t));
+    memmove(leaf->values + pos + 1, leaf->values + pos, (count - pos) * sizeof(bpt_value_t));
+    leaf->keys[pos] = key;
+    leaf->values[pos] = value;
+    node->count = count + 1;
+    tree->count++;
+    return true;
+}
+
+/*
+ * Odebere z vnitřního uzlu oddělovač index a pravý podstrom za ním.
+ */
+static void bpt_remove_separator(bpt_inner_t *inner, uint32_t index) {
+    uint32_t count = inner->node.count;
+    memmove(inner->keys + index, inner->keys + index + 1, (count - index - 1) * sizeof(bpt_key_t));
+    memmove(inner->children + index + 1, inner->children + index + 2, (count - index - 1) * sizeof(bpt_node_t *));
+    inner->node.count = count - 1;
+}
+
+/*
+ * Sloučí potomky parent->children[index] a parent->children[index + 1]
+ * do levého z nich a pravý uvolní.
+ */
+static void bpt_merge(bpt_inner_t *parent, uint32_t index) {
+    bpt_node_t *left = parent->children[index];
+    bpt_node_t *right = parent->children[index + 1];
+
+    if (left->leaf) {
+        bpt_leaf_t *l = bpt_as_leaf(left), *r = bpt_as_leaf(right);
+        memcpy(l->keys + left->count, r->keys, right->count * sizeof(bpt_key_t));
+        memcpy(l->values + left->count, r->values, right->count * sizeof(bpt_value_t));
+        l->next = r->next;
+        left->count += right->count;
+    } else {
+        // The separator comes down between the two key ranges.
+        bpt_inner_t *l = bpt_as_inner(left), *r = bpt_as_inner(right);
+        l->keys[left->count] = parent->keys[index];
+        memcpy(l->keys + left->count + 1, r->keys, right->count * sizeof(bpt_key_t));
+        memcpy(l->children + left->count + 1, r->children, (right->count + 1) * sizeof(bpt_node_t *));
+        left->count += right->count + 1;
+    }
+    bpt_remove_separator(parent, index);
+    free(right);
+}
+
+/*
+ * Přesune jeden klíč z levého sourozence do parent->children[index].
+ */
+static void bpt_borrow_left(bpt_inner_t *parent, uint32_t index) {
+    bpt_node_t *child = parent->children[index];
+    bpt_node_t *sibling = parent->children[index - 1];
+    uint32_t count = child->count;
+
+    if (child->leaf) {
+        bpt_leaf_t *c = bpt_as_leaf(child), *s = bpt_as_leaf(sibling);
+        memmove(c->keys + 1, c->keys, count * sizeof(bpt_key_t));
+        memmove(c->values + 1, c->values, count * sizeof(bpt_value_t));
+        c->keys[0] = s->keys[sibling->count - 1];
+        c->values[0] = s->values[sibling->count - 1];
+        parent->keys[index - 1] = c->keys[0];
+    } else {
+        // Rotate through the parent: its separator comes down, the sibling's last key goes up.
+        bpt_inner_t *c = bpt_as_inner(child), *s = bpt_as_inner(sibling);
+        memmove(c->keys + 1, c->keys, count * sizeof(bpt_key_t));
+        memmove(c->children + 1, c->children, (count + 1) * sizeof(bpt_node_t *));
+        c->keys[0] = parent->keys[index - 1];
+        c->children[0] = s->children[sibling->count];
+        parent->keys[index - 1] = s->keys[sibling->count - 1];
+    }
+    child->count = count + 1;
+    sibling->count--;
+}
+
+/*
+ * Přesune jeden klíč z pravého sourozence do parent->children[index].
+ */
+static void bpt_borrow_right(bpt_inner_t *parent, uint32_t index) {
+    bpt_node_t *child = parent->children[index];
+    bpt_node_t *sibling = parent->children[index + 1];
+    uint32_t count = child->count;
+    uint32_t rest = sibling->count - 1;
+
+    if (child->leaf) {
+        bpt_leaf_t *c = bpt_as_leaf(child), *s = bpt_as_leaf(sibling);
+        c->keys[count] = s->keys[0];
+        c->values[count] = s->values[0];
+        memmove(s->keys, s->keys + 1, rest * sizeof(bpt_key_t));
+        memmove(s->values, s->values + 1, rest * sizeof(bpt_value_t));
+        parent->keys[index] = s->keys[0];
+    } else {
+        bpt_inner_t *c = bpt_as_inner(child), *s = bpt_as_inner(sibling);
+        c->keys[count] = parent->keys[index];
+        c->children[count + 1] = s->children[0];
+        parent->keys[index] = s->keys[0];
+        memmove(s->keys, s->keys + 1, rest * sizeof(bpt_key_t));
+        memmove(s->children, s->children + 1, (rest + 1) * sizeof(bpt_node_t *));
+    }
+    child->count = count + 1;
+    sibling->count = rest;
+}
+
+/*
+ * Zajistí, že potomek parent->children[index] má víc než minimum klíčů,
+ * aby z něj šlo mazat. Vrací index potomka, do kterého se má sestoupit
+ * (po sloučení s levým sourozencem se posune o jedna).
+ */
+static uint32_t bpt_fill_child(bpt_inner_t *parent, uint32_t index) {
+    bpt_node_t *child = parent->children[index];
+    uint32_t min = child->leaf ? BPT_LEAF_MIN : BPT_INNER_MIN;
+    if (child->count > min) {
+        return index;
+    }
+    if (index > 0 && parent->children[index - 1]->count > min) {
+        bpt_borrow_left(parent, index);
+    } else if (index < parent->node.count && parent->children[index + 1]->count > min) {
+        bpt_borrow_right(parent, index);
+    } else if (index < parent->node.count) {
+        bpt_merge(parent, index);
+    } else {
+        bpt_merge(parent, index - 1);
+        index--;
+    }
+    return index;
+}
+
+/*
+ * Smazání klíče. Pokud klíč ve stromu není, funkce nic nedělá.
+ */
+void bpt_delete(bpt_tree_t *tree, bpt_key_t key) {
+    if (tree->root == NULL) {
+        return;
+    }
+    bpt_node_t *node = tree->root;
+    while (!node->leaf) {
+        bpt_inner_t *inner = bpt_as_inner(node);
+        uint32_t index = bpt_fill_child(inner, bpt_rank(inner->keys, node->count, key, false));
+        // A merge may have emptied the root; its only child takes over.
+        if (node == tree->root && node->count == 0) {
+            tree->root = inner->children[0];
+            tree->height--;
+            free(inner);
+            node = tree->root;
+            continue;
+        }
+        node = inner->children[index];
+    }
+
+    bpt_leaf_t *leaf = bpt_as_leaf(node);
+    uint32_t count = node->count;
+    uint32_t pos = bpt_rank(leaf->keys, count, key, true);
+    if (pos == count || leaf->keys[pos] != key) {
+        return;
+    }
+    memmove(leaf->keys + pos, leaf->keys + pos + 1, (count - pos - 1) * sizeof(bpt_key_t));
+    memmove(leaf->values + pos, leaf->values + pos + 1, (count - pos - 1) * sizeof(bpt_value_t));
+    node->count = count - 1;
+    tree->count--;
+
+    if (tree->count == 0) {
+        free(tree->root);
+        bpt_init(tree);
+    }
+}
+
+static void bpt_free_node(bpt_node_t *node) {
+    if (!node->leaf) {
+        bpt_inner_t *inner = bpt_as_inner(node);
+        for (uint32_t i = 0; i <= node->count; i++) {
+            bpt_free_node(inner->children[i]);
+        }
+    }
+    free(node);
+}
+
+/*
+ * Zrušení celého stromu. Po zrušení je strom ve stejném stavu jako po
+ * inicializaci. Hloubka rekurze je rovna výšce stromu.
+ */
+void bpt_dispose(bpt_tree_t *tree) {
+    if (tree->root != NULL) {
+        bpt_free_node(tree->root);
+    }
+    bpt_init(tree);
+}
+
+/*
+ * Seřazený průchod od klíče from: zapíše nejvýše max klíčů větších nebo
+ * rovných from a jejich hodnot do polí keys a values (values smí být NULL)
+ * a vrátí jejich počet. Další stránku vrátí volání s from o jedna větším
+ * než poslední vrácený klíč.
+ */
+size_t bpt_scan(const bpt_tree_t *tree, bpt_key_t from, bpt_key_t *keys, bpt_value_t *values, size_t max) {
+    if (tree->root == NULL) {
+        return 0;
+    }
+    const bpt_leaf_t *leaf = bpt_find_leaf(tree->root, from);
+    uint32_t pos = bpt_rank(leaf->keys, leaf->node.count, from, true);
+    size_t found = 0;
+
+    // Leaves are linked, so the scan reads them one after another.
+    while (leaf != NULL && found < max) {
+        size_t take = leaf->node.count - pos;
+        take = take < max - found ? take : max - found;
+        memcpy(keys + found, leaf->keys + pos, take * sizeof(bpt_key_t));
+        if (values != NULL) {
+            memcpy(values + found, leaf->values + pos, take * sizeof(bpt_value_t));
+        }
+        found += take;
+        leaf = leaf->next;
+        pos = 0;
+    }
+    return found;
+}
+
+/*
+ * Inorder průchod stromem: zapíše všech tree->count klíčů a hodnot
+ * vzestupně do polí keys a values (values smí být NULL).
+ */
+void bpt_inorder(const bpt_tree_t *tree, bpt_key_t *keys, bpt_value_t *values) {
+    if (tree->root == NULL) {
+        return;
+    }
+    const bpt_node_t *node = tree->root;
+    while (!node->leaf) {
+        node = ((const bpt_inner_t *)node)->children[0];
+    }
+    size_t found = 0;
+    for (const bpt_leaf_t *leaf = (const bpt_leaf_t *)node; leaf != NULL; leaf = leaf->next) {
+        memcpy(keys + found, leaf->keys, leaf->node.count * sizeof(bpt_key_t));
+        if (values != NULL) {
+            memcpy(values + found, leaf->values, leaf->node.count * sizeof(bpt_value_t));
+        }
+        found += leaf->node.count;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * B+ strom
+ *
+ * Alternativa k binárnímu vyhledávacímu stromu pro velké seřazené indexy.
+ * Uzel má velikost BPT_NODE_SIZE bajtů (násobek cache line) a klíče uzlu
+ * leží v poli za sebou, takže hledání v uzlu čte jednu až čtyři cache line
+ * místo jednoho výpadku cache na každé patro binárního stromu. Hodnoty
+ * jsou jen v listech a listy jsou propojené, seřazený průchod je tedy
+ * sekvenční čtení listů.
+ *
+ * Operace odpovídají btree.h: bpt_init, bpt_search, bpt_insert,
+ * bpt_delete, bpt_dispose a seřazený průchod bpt_inorder; bpt_scan
+ * navíc vrací nejvýše max prvků od zadaného klíče (stránkování).
+ */
+
+#ifndef IAL_BPLUSTREE_H
+#define IAL_BPLUSTREE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int64_t bpt_key_t;
+typedef int64_t bpt_value_t;
+
+// Bytes per node; 256 is four cache lines and gives 15 keys per node.
+#define BPT_NODE_SIZE 256
+// Keys that fit next to the header and the next-leaf pointer or the extra child pointer.
+#define BPT_LEAF_KEYS ((BPT_NODE_SIZE - sizeof(bpt_node_t) - sizeof(void *)) / (sizeof(bpt_key_t) + sizeof(bpt_value_t)))
+#define BPT_INNER_KEYS ((BPT_NODE_SIZE - sizeof(bpt_node_t) - sizeof(void *)) / (sizeof(bpt_key_t) + sizeof(void *)))
+
+typedef struct bpt_node {
+  uint32_t count; // počet klíčů v uzlu
+  uint32_t leaf;  // nenulové pro list
+} bpt_node_t;
+
+typedef struct bpt_leaf {
+  bpt_node_t node;                   // hlavička
+  struct bpt_leaf *next;             // následující list
+  bpt_key_t keys[BPT_LEAF_KEYS];     // seřazené klíče
+  bpt_value_t values[BPT_LEAF_KEYS]; // hodnoty ke klíčům
+} bpt_leaf_t;
+
+typedef struct bpt_inner {
+  bpt_node_t node;                          // hlavička
+  bpt_key_t keys[BPT_INNER_KEYS];           // keys[i] odděluje children[i] a children[i + 1]
+  bpt_node_t *children[BPT_INNER_KEYS + 1]; // podstromy
+} bpt_inner_t;
+
+typedef struct bpt_tree {
+  bpt_node_t *root; // kořen, NULL pro prázdný strom
+  size_t count;     // počet klíčů
+  unsigned height;  // počet pater, 0 pro prázdný strom
+} bpt_tree_t;
+
+void bpt_init(bpt_tree_t *tree);
+bool bpt_search(const bpt_tree_t *tree, bpt_key_t key, bpt_value_t *value);
+bool bpt_insert(bpt_tree_t *tree, bpt_key_t key, bpt_value_t value);
+void bpt_delete(bpt_tree_t *tree, bpt_key_t key);
+void bpt_dispose(bpt_tree_t *tree);
+size_t bpt_scan(const bpt_tree_t *tree, bpt_key_t from, bpt_key_t *keys, bpt_value_t *values, size_t max);
+void bpt_inorder(const bpt_tree_t *tree, bpt_key_t *keys, bpt_value_t *values);
+
+#endif
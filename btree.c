@@ -6,9 +6,24 @@
  */
 
 #include "../btree.h"
+#include "btree_ext.h"
+#include "stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 
+/*
+ * Velikost uzlu této varianty (viz btree_ext.h).
+ */
+const size_t bst_node_size = sizeof(bst_node_t);
+
+/*
+ * Dokončení stromu, jehož uzly přepojil kód mimo tento soubor. Uzly této
+ * varianty nenesou žádné odvozené údaje, není tedy co přepočítat.
+ */
+void bst_relinked(bst_node_t *tree) {
+    (void)tree;
+}
+
 /*
  * Inicializace stromu.
  *
@@ -32,22 +47,23 @@ void bst_init(bst_node_t **tree) {
  * Funkci implementujte rekurzivně bez použité vlastních pomocných funkcí.
  */
 bool bst_search(bst_node_t *tree, char key, int *value) {
-    // Check if the current node is not null.
-    if (tree) {
-        // Check if the current node's key matches the search key.
-        if (tree->key == key) {
-            // If it matches, store the value in the provided address and return true.
-            *value = tree->value;
-            return true;
-        }
-        // Recursively search in the left and right subtrees.
-        // If the key is found in either subtree, return true.
-        if (bst_search(tree->left, key, value) || bst_search(tree->right, key, value)) {
-            return true;
-        }
+    // An empty subtree cannot contain the key.
+    if (tree == NULL) {
+        STATS_END(bst_search);
+        return false;
     }
-    // If the key is not found in the tree or the tree is empty, return false.
-    return false;
+    STATS_STEP();
+    // Check if the current node's key matches the search key.
+    if (tree->key == key) {
+        // If it matches, store the value in the provided address and return true.
+        *value = tree->value;
+        STATS_END(bst_search);
+        return true;
+    }
+    // Only one subtree can hold the key, so descend into that one alone.
+    // The call is in tail position: optimizing compilers turn it into a jump,
+    // which makes the lookup a loop over O(height) nodes with no stack growth.
+    return bst_search(key < tree->key ? tree->left : tree->right, key, value);
 }
 
 /*
@@ -64,22 +80,32 @@ bool bst_search(bst_node_t *tree, char key, int *value) {
 void bst_insert(bst_node_t **tree, char key, int value) {
     // Check if the current node (root or subtree) is NULL, indicating an insertion point.
     if (*tree == NULL) {
-        // Dynamically allocate memory for the new node.
-        *tree = (bst_node_t *)malloc(sizeof(struct bst_node));
+        STATS_END(bst_insert);
+        // Allocate the new node, from the pool set by bst_use_pool if there is one.
+        bst_node_t *node = bst_node_alloc();
+        // Out of memory (or a pool too small for the node): leave the tree unchanged.
+        if (node == NULL) {
+            return;
+        }
         // Set the new node's key and value.
-        (*tree)->key = key;
-        (*tree)->value = value;
+        node->key = key;
+        node->value = value;
         // Initialize the left and right children of the new node to NULL.
-        (*tree)->left = NULL;
-        (*tree)->right = NULL;
+        node->left = NULL;
+        node->right = NULL;
+        *tree = node;
     } else if (key < (*tree)->key) {
         // If the key is less than the current node's key, recurse on the left subtree.
+        STATS_STEP();
         bst_insert(&(*tree)->left, key, value);
     } else if (key > (*tree)->key) {
         // If the key is greater than the current node's key, recurse on the right subtree.
+        STATS_STEP();
         bst_insert(&(*tree)->right, key, value);
     } else {
         // If the key already exists in the tree, update the node's value.
+        STATS_STEP();
+        STATS_END(bst_insert);
         (*tree)->value = value;
     }
 }
@@ -95,22 +121,21 @@ void bst_insert(bst_node_t **tree, char key, int value) {
  * 
  * Tato pomocná funkce bude využitá při implementaci funkce bst_delete.
  *
- * Funkci implementujte rekurzivně bez použití vlastních pomocných funkcí.
+ * Funkce prochází strom cyklem, hloubka zásobníku volání nezávisí na tvaru
+ * stromu (zdegenerovaný strom ze seřazeného vstupu má hloubku n).
  */
 void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree) {
-    // Check if the right child of the current node is NULL,
-    // indicating that the current node is the rightmost node.
-    if ((*tree)->right == NULL) {
-        // Replace the target node's key and value with that of the rightmost node.
-        target->key = (*tree)->key;
-        target->value = (*tree)->value;
-        // Free the memory allocated for the rightmost node and set it to NULL.
-        free((*tree));
-        (*tree) = NULL;
-    } else {
-        // If the right child exists, recursively call the function to find the rightmost node.
-        bst_replace_by_rightmost(target, &(*tree)->right);
+    // Follow the right links down to the rightmost node.
+    while ((*tree)->right != NULL) {
+        tree = &(*tree)->right;
     }
+    bst_node_t *rightmost = *tree;
+    // Replace the target node's key and value with that of the rightmost node.
+    target->key = rightmost->key;
+    target->value = rightmost->value;
+    // The rightmost node may still have a left subtree; its parent inherits it.
+    *tree = rightmost->left;
+    bst_node_free(rightmost);
 }
 
 /*
@@ -123,53 +148,31 @@ void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree) {
  * 
  * Funkce korektně uvolní všechny alokované zdroje odstraněného uzlu.
  * 
- * Funkci implementujte rekurzivně pomocí bst_replace_by_rightmost a bez
- * použití vlastních pomocných funkcí.
+ * Funkce hledá uzel cyklem a využívá bst_replace_by_rightmost, hloubka
+ * zásobníku volání nezávisí na tvaru stromu.
  */
 void bst_delete(bst_node_t **tree, char key) {
-    // Check if the current node's key matches the key to be deleted.
-    if ((*tree)->key == key) {
-        //Node with only a left child or no child.
-        if ((*tree)->right == NULL) {
-            if ((*tree)->left != NULL) {
-                // Node has only a left child.
-                bst_node_t *tmp = (*tree)->left;
-                (*tree)->key = (*tree)->left->key;
-                (*tree)->value = (*tree)->left->value;
-                (*tree)->right = (*tree)->left->right;
-                (*tree)->left = (*tree)->left->left;
-                free(tmp);
-                tmp = NULL;
-            } else {
-                // Node is a leaf.
-                free(*tree);
-                *tree = NULL;
-            }
-        } else {
-            //Node with only a right child.
-            if ((*tree)->left == NULL) {
-                bst_node_t *tmp = (*tree)->right;
-                (*tree)->key = (*tree)->right->key;
-                (*tree)->value = (*tree)->right->value;
-                (*tree)->left = (*tree)->right->left;
-                (*tree)->right = (*tree)->right->right;
-                free(tmp);
-                tmp = NULL;
-            } else {
-                //Node with two children.
-                bst_replace_by_rightmost(*tree, &(*tree)->left);
-            }
-        }
-    } else if (key < (*tree)->key && (*tree)->left != NULL) {
-        // If the key to be deleted is less than the current node's key, recurse on the left subtree.
-        bst_delete(&(*tree)->left, key);
-    } else if (key > (*tree)->key && (*tree)->right != NULL) {
-        // If the key to be deleted is greater than the current node's key, recurse on the right subtree.
-        bst_delete(&(*tree)->right, key);
-    } else if (*tree == NULL) {
-        // If the tree is empty, simply return.
+    // Walk the link that points at the current node, so it can be rewritten in place.
+    while (*tree != NULL && (*tree)->key != key) {
+        STATS_STEP();
+        tree = key < (*tree)->key ? &(*tree)->left : &(*tree)->right;
+    }
+    // The key is not in the tree.
+    if (*tree == NULL) {
+        STATS_END(bst_delete);
         return;
     }
+    STATS_STEP();
+    STATS_END(bst_delete);
+    bst_node_t *node = *tree;
+    if (node->left != NULL && node->right != NULL) {
+        // Node with two children takes over the rightmost node of its left subtree.
+        bst_replace_by_rightmost(node, &node->left);
+    } else {
+        // Node with at most one child: the parent inherits that child.
+        *tree = node->left != NULL ? node->left : node->right;
+        bst_node_free(node);
+    }
 }
 
 /*
@@ -179,21 +182,27 @@ void bst_delete(bst_node_t **tree, char key) {
  * inicializaci. Funkce korektně uvolní všechny alokované zdroje rušených 
  * uzlů.
  * 
- * Funkci implementujte rekurzivně bez použití vlastních pomocných funkcí.
+ * Funkce nepoužívá rekurzi ani zásobník: pravými rotacemi přesouvá levé
+ * podstromy nahoru, takže vždy uvolňuje uzel bez levého potomka a pokračuje
+ * doprava. Čas je O(n) a paměť O(1) pro libovolný tvar stromu.
  */
 void bst_dispose(bst_node_t **tree) {
-    // Check if the current node (root or subtree) is NULL.
-    // If it is, there's nothing to free, so return immediately.
-    if ((*tree) == NULL) {
-        return;
+    bst_node_t *node = *tree;
+    while (node != NULL) {
+        if (node->left != NULL) {
+            // Rotate right: the left child becomes the current node.
+            bst_node_t *left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            // No left subtree left to take care of, free the node and move right.
+            bst_node_t *right = node->right;
+            bst_node_free(node);
+            node = right;
+        }
     }
-    // Recursively call bst_dispose on the left subtree.
-    bst_dispose(&(*tree)->left);
-    // Recursively call bst_dispose on the right subtree.
-    bst_dispose(&(*tree)->right);
-    // free the current node itself.
-    free((*tree));
-    (*tree) = NULL;
+    *tree = NULL;
 }
 
 /*
@@ -238,3 +247,50 @@ void bst_postorder(bst_node_t *tree, bst_items_t *items) {
     bst_postorder(tree->right, items);
     bst_add_node_to_items(tree, items);
 }
+
+/*
+ * Počet uzlů stromu. Tato varianta počet neudržuje, projde proto celý
+ * strom (bez alokace).
+ */
+size_t bst_size(bst_node_t *tree) {
+    if (tree == NULL) {
+        return 0;
+    }
+    return bst_size(tree->left) + 1 + bst_size(tree->right);
+}
+
+/*
+ * Preorder průchod stromem s funkcí visit.
+ *
+ * Pro každý uzel zavolá visit(uzel, context); pokud visit vrátí false,
+ * průchod skončí a funkce vrátí false. Nic nealokuje.
+ */
+bool bst_preorder_visit(bst_node_t *tree, bst_visitor_t visit, void *context) {
+    if (tree == NULL) {
+        return true;
+    }
+    return visit(tree, context) && bst_preorder_visit(tree->left, visit, context) &&
+           bst_preorder_visit(tree->right, visit, context);
+}
+
+/*
+ * Inorder průchod stromem s funkcí visit (viz bst_preorder_visit).
+ */
+bool bst_inorder_visit(bst_node_t *tree, bst_visitor_t visit, void *context) {
+    if (tree == NULL) {
+        return true;
+    }
+    return bst_inorder_visit(tree->left, visit, context) && visit(tree, context) &&
+           bst_inorder_visit(tree->right, visit, context);
+}
+
+/*
+ * Postorder průchod stromem s funkcí visit (viz bst_preorder_visit).
+ */
+bool bst_postorder_visit(bst_node_t *tree, bst_visitor_t visit, void *context) {
+    if (tree == NULL) {
+        return true;
+    }
+    return bst_postorder_visit(tree->left, visit, context) && bst_postorder_visit(tree->right, visit, context) &&
+           visit(tree, context);
+}
@@ -0,0 +1,380 @@
+/*
+ * Binární vyhledávací strom — vyvážená varianta (AVL)
+ *
+ * Implementuje stejné rozhraní jako btree.c a btree_iter.c (a linkuje se
+ * místo nich), ale po každém vložení a smazání strom vyvažuje rotacemi tak,
+ * aby se výšky podstromů libovolného uzlu lišily nejvýše o jedna. Výška
+ * stromu je tak O(log n) i pro seřazený vstup a bst_balance není potřeba.
+ *
+ * Uzly jsou typu bst_avl_node_t (viz btree_ext.h), který začíná uzlem
+ * bst_node_t a navíc nese výšku a počet uzlů podstromu. Počty udržují
+ * rotace i vkládání a mazání, takže bst_rank, bst_select a bst_count_range
+ * běží v čase O(log n).
+ */
+
+#include "../btree.h"
+#include "btree_ext.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static inline int bst_avl_height(bst_node_t *tree) {
+    return tree != NULL ? ((bst_avl_node_t *)tree)->height : 0;
+}
+
+static inline int bst_avl_size(bst_node_t *tree) {
+    return tree != NULL ? ((bst_avl_node_t *)tree)->size : 0;
+}
+
+static inline void bst_avl_update(bst_node_t *tree) {
+    int left = bst_avl_height(tree->left);
+    int right = bst_avl_height(tree->right);
+    ((bst_avl_node_t *)tree)->height = (left > right ? left : right) + 1;
+    ((bst_avl_node_t *)tree)->size = bst_avl_size(tree->left) + bst_avl_size(tree->right) + 1;
+}
+
+/*
+ * Pravá rotace: levý potomek se stane kořenem podstromu. Vrací nový kořen.
+ */
+static bst_node_t *bst_avl_rotate_right(bst_node_t *tree) {
+    bst_node_t *pivot = tree->left;
+    tree->left = pivot->right;
+    pivot->right = tree;
+    bst_avl_update(tree);
+    bst_avl_update(pivot);
+    return pivot;
+}
+
+/*
+ * Levá rotace: pravý potomek se stane kořenem podstromu. Vrací nový kořen.
+ */
+static bst_node_t *bst_avl_rotate_left(bst_node_t *tree) {
+    bst_node_t *pivot = tree->right;
+    tree->right = pivot->left;
+    pivot->left = tree;
+    bst_avl_update(tree);
+    bst_avl_update(pivot);
+    return pivot;
+}
+
+/*
+ * Přepočítá výšku uzlu a je-li podstrom nevyvážený (rozdíl výšek 2),
+ * vyváží ho jednou nebo dvěma rotacemi. Vrací nový kořen podstromu.
+ */
+static bst_node_t *bst_avl_rebalance(bst_node_t *tree) {
+    int balance = bst_avl_height(tree->left) - bst_avl_height(tree->right);
+    if (balance > 1) {
+        // Left-right case turns into left-left first.
+        if (bst_avl_height(tree->left->left) < bst_avl_height(tree->left->right)) {
+            tree->left = bst_avl_rotate_left(tree->left);
+        }
+        return bst_avl_rotate_right(tree);
+    }
+    if (balance < -1) {
+        if (bst_avl_height(tree->right->right) < bst_avl_height(tree->right->left)) {
+            tree->right = bst_avl_rotate_right(tree->right);
+        }
+        return bst_avl_rotate_left(tree);
+    }
+    bst_avl_update(tree);
+    return tree;
+}
+
+/*
+ * Velikost uzlu této varianty (viz btree_ext.h).
+ */
+const size_t bst_node_size = sizeof(bst_avl_node_t);
+
+/*
+ * Přepočítá výšky a počty uzlů podstromů celého stromu, jehož uzly
+ * přepojil kód mimo tento soubor (bst_balance, bst_build_from_sorted).
+ * Strom musí být vyvážený, hloubka rekurze je pak O(log n).
+ */
+void bst_relinked(bst_node_t *tree) {
+    if (tree == NULL) {
+        return;
+    }
+    bst_relinked(tree->left);
+    bst_relinked(tree->right);
+    bst_avl_update(tree);
+}
+
+/*
+ * Inicializace stromu.
+ *
+ * Uživatel musí zajistit, že inicializace se nebude opakovaně volat nad
+ * inicializovaným stromem. V opačném případě může dojít k úniku paměti (memory
+ * leak).
+ */
+void bst_init(bst_node_t **tree) {
+    *tree = NULL;
+}
+
+/*
+ * Vyhledání uzlu v stromu.
+ *
+ * V případě úspěchu vrátí funkce hodnotu true a do proměnné value zapíše
+ * hodnotu daného uzlu. V opačném případě funkce vrátí hodnotu false a proměnná
+ * value zůstává nezměněná.
+ */
+bool bst_search(bst_node_t *tree, char key, int *value) {
+    while (tree != NULL) {
+        STATS_STEP();
+        if (key == tree->key) {
+            *value = tree->value;
+            STATS_END(bst_search);
+            return true;
+        }
+        tree = key < tree->key ? tree->left : tree->right;
+    }
+    STATS_END(bst_search);
+    return false;
+}
+
+/*
+ * Vložení uzlu do stromu.
+ *
+ * Pokud uzel se zadaným klíčem už ve stromu existuje, nahradí jeho hodnotu.
+ * Jinak vloží nový listový uzel a na cestě zpět ke kořeni strom vyváží.
+ * Při nedostatku paměti zůstane strom beze změny.
+ */
+void bst_insert(bst_node_t **tree, char key, int value) {
+    if (*tree == NULL) {
+        STATS_END(bst_insert);
+        bst_node_t *node = bst_node_alloc_size(bst_node_size);
+        if (node == NULL) {
+            return;
+        }
+        node->key = key;
+        node->value = value;
+        node->left = NULL;
+        node->right = NULL;
+        ((bst_avl_node_t *)node)->height = 1;
+        ((bst_avl_node_t *)node)->size = 1;
+        *tree = node;
+        return;
+    }
+    STATS_STEP();
+    if (key < (*tree)->key) {
+        bst_insert(&(*tree)->left, key, value);
+    } else if (key > (*tree)->key) {
+        bst_insert(&(*tree)->right, key, value);
+    } else {
+        // Existing key, the shape does not change.
+        STATS_END(bst_insert);
+        (*tree)->value = value;
+        return;
+    }
+    *tree = bst_avl_rebalance(*tree);
+}
+
+/*
+ * Pomocná funkce která nahradí uzel nejpravějším potomkem.
+ *
+ * Klíč a hodnota uzlu target budou nahrazeny klíčem a hodnotou nejpravějšího
+ * uzlu podstromu tree. Nejpravější uzel bude odstraněn (jeho levý podstrom
+ * zdědí rodič) a podstrom tree se na cestě zpět vyváží.
+ *
+ * Funkce předpokládá, že hodnota tree není NULL.
+ */
+void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree) {
+    if ((*tree)->right == NULL) {
+        bst_node_t *rightmost = *tree;
+        target->key = rightmost->key;
+        target->value = rightmost->value;
+        *tree = rightmost->left;
+        bst_node_free(rightmost);
+        return;
+    }
+    bst_replace_by_rightmost(target, &(*tree)->right);
+    *tree = bst_avl_rebalance(*tree);
+}
+
+/*
+ * Odstranění uzlu ze stromu.
+ *
+ * Pokud uzel se zadaným klíčem neexistuje, funkce nic nedělá. Pokud má
+ * odstraněný uzel nejvýše jeden podstrom, zdědí ho rodič, jinak je nahrazený
+ * nejpravějším uzlem levého podstromu. Na cestě zpět ke kořeni se strom
+ * vyváží.
+ */
+void bst_delete(bst_node_t **tree, char key) {
+    if (*tree == NULL) {
+        STATS_END(bst_delete);
+        return;
+    }
+    STATS_STEP();
+    if (key < (*tree)->key) {
+        bst_delete(&(*tree)->left, key);
+    } else if (key > (*tree)->key) {
+        bst_delete(&(*tree)->right, key);
+    } else if ((*tree)->left == NULL || (*tree)->right == NULL) {
+        // The remaining child (if any) is a valid AVL subtree already.
+        STATS_END(bst_delete);
+        bst_node_t *victim = *tree;
+        *tree = victim->left != NULL ? victim->left : victim->right;
+        bst_node_free(victim);
+        return;
+    } else {
+        STATS_END(bst_delete);
+        bst_replace_by_rightmost(*tree, &(*tree)->left);
+    }
+    *tree = bst_avl_rebalance(*tree);
+}
+
+/*
+ * Zrušení celého stromu.
+ *
+ * Po zrušení se celý strom bude nacházet ve stejném stavu jako po
+ * inicializaci. Stejně jako v btree.c bez rekurze, pravými rotacemi.
+ */
+void bst_dispose(bst_node_t **tree) {
+    bst_node_t *node = *tree;
+    while (node != NULL) {
+        if (node->left != NULL) {
+            bst_node_t *left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            bst_node_t *right = node->right;
+            bst_node_free(node);
+            node = right;
+        }
+    }
+    *tree = NULL;
+}
+
+/*
+ * Počet klíčů menších než key.
+ */
+size_t bst_rank(bst_node_t *tree, char key) {
+    size_t rank = 0;
+    while (tree != NULL) {
+        if (key <= tree->key) {
+            tree = tree->left;
+        } else {
+            // The whole left subtree and this node precede key.
+            rank += (size_t)bst_avl_size(tree->left) + 1;
+            tree = tree->right;
+        }
+    }
+    return rank;
+}
+
+/*
+ * Uzel s rank-tým nejmenším klíčem (od nuly), NULL pokud má strom méně
+ * uzlů.
+ */
+bst_node_t *bst_select(bst_node_t *tree, size_t rank) {
+    while (tree != NULL) {
+        size_t left = (size_t)bst_avl_size(tree->left);
+        if (rank == left) {
+            return tree;
+        }
+        if (rank < left) {
+            tree = tree->left;
+        } else {
+            rank -= left + 1;
+            tree = tree->right;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Počet klíčů v intervalu [lo, hi].
+ */
+size_t bst_count_range(bst_node_t *tree, char lo, char hi) {
+    if (lo > hi) {
+        return 0;
+    }
+    int value;
+    size_t below_hi = bst_rank(tree, hi) + bst_search(tree, hi, &value);
+    return below_hi - bst_rank(tree, lo);
+}
+
+/*
+ * Preorder průchod stromem.
+ *
+ * Pro aktuálně zpracovávaný uzel zavolá funkci bst_add_node_to_items.
+ */
+void bst_preorder(bst_node_t *tree, bst_items_t *items) {
+    if (tree == NULL) {
+        return;
+    }
+    bst_add_node_to_items(tree, items);
+    bst_preorder(tree->left, items);
+    bst_preorder(tree->right, items);
+}
+
+/*
+ * Inorder průchod stromem.
+ *
+ * Pro aktuálně zpracovávaný uzel zavolá funkci bst_add_node_to_items.
+ */
+void bst_inorder(bst_node_t *tree, bst_items_t *items) {
+    if (tree == NULL) {
+        return;
+    }
+    bst_inorder(tree->left, items);
+    bst_add_node_to_items(tree, items);
+    bst_inorder(tree->right, items);
+}
+
+/*
+ * Postorder průchod stromem.
+ *
+ * Pro aktuálně zpracovávaný uzel zavolá funkci bst_add_node_to_items.
+ */
+void bst_postorder(bst_node_t *tree, bst_items_t *items) {
+    if (tree == NULL) {
+        return;
+    }
+    bst_postorder(tree->left, items);
+    bst_postorder(tree->right, items);
+    bst_add_node_to_items(tree, items);
+}
+
+/*
+ * Počet uzlů stromu, udržovaný v kořeni, v čase O(1).
+ */
+size_t bst_size(bst_node_t *tree) {
+    return (size_t)bst_avl_size(tree);
+}
+
+/*
+ * Preorder průchod stromem s funkcí visit.
+ *
+ * Pro každý uzel zavolá visit(uzel, context); pokud visit vrátí false,
+ * průchod skončí a funkce vrátí false. Nic nealokuje.
+ */
+bool bst_preorder_visit(bst_node_t *tree, bst_visitor_t visit, void *context) {
+    if (tree == NULL) {
+        return true;
+    }
+    return visit(tree, context) && bst_preorder_visit(tree->left, visit, context) &&
+           bst_preorder_visit(tree->right, visit, context);
+}
+
+/*
+ * Inorder průchod stromem s funkcí visit (viz bst_preorder_visit).
+ */
+bool bst_inorder_visit(bst_node_t *tree, bst_visitor_t visit, void *context) {
+    if (tree == NULL) {
+        return true;
+    }
+    return bst_inorder_visit(tree->left, visit, context) && visit(tree, context) &&
+           bst_inorder_visit(tree->right, visit, context);
+}
+
+/*
+ * Postorder průchod stromem s funkcí visit (viz bst_preorder_visit).
+ */
+bool bst_postorder_visit(bst_node_t *tree, bst_visitor_t visit, void *context) {
+    if (tree == NULL) {
+        return true;
+    }
+    return bst_postorder_visit(tree->left, visit, context) && bst_postorder_visit(tree->right, visit, context) &&
+           visit(tree, context);
+}
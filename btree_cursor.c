@@ -0,0 +1,138 @@
+/*
+ * Binární vyhledávací strom — kurzor a rozsahové dotazy
+ *
+ * Líný inorder průchod: kurzor se nastaví na první, poslední nebo zadaný
+ * klíč a dál se posouvá po jednom uzlu oběma směry. Používá stejný postup
+ * jako bst_leftmost_inorder v btree_iter.c (uložení levé větve), jen cestu
+ * neodebírá ze zásobníku celou najednou, takže lze vracet uzly na požádání
+ * a kdykoli skončit. Funguje nad uzly libovolné varianty stromu.
+ *
+ * Stránkování po deseti klíčích od klíče 'k':
+ *
+ *   bst_cursor_t cursor;
+ *   for (bool ok = bst_cursor_seek(&cursor, tree, 'k'); ok && n < 10; ok = bst_cursor_next(&cursor))
+ *       page[n++] = bst_cursor_node(&cursor);
+ *
+ * Rozsahový dotaz bst_range prochází kurzorem jen uzly v intervalu a cestu
+ * k prvnímu z nich, tedy O(h + k) uzlů pro strom výšky h a k výsledků.
+ */
+
+#include "../btree.h"
+#include "btree_ext.h"
+
+/*
+ * Přidá na konec cesty uzel tree a celou jeho levou (left) nebo pravou
+ * větev.
+ */
+static void bst_cursor_descend(bst_cursor_t *cursor, bst_node_t *tree, bool left) {
+    while (tree != NULL) {
+        cursor->path[cursor->depth++] = tree;
+        tree = left ? tree->left : tree->right;
+    }
+}
+
+/*
+ * Nastaví kurzor na uzel s nejmenším klíčem. Vrací false pro prázdný strom.
+ */
+bool bst_cursor_first(bst_cursor_t *cursor, bst_node_t *tree) {
+    cursor->depth = 0;
+    bst_cursor_descend(cursor, tree, true);
+    return cursor->depth > 0;
+}
+
+/*
+ * Nastaví kurzor na uzel s největším klíčem. Vrací false pro prázdný strom.
+ */
+bool bst_cursor_last(bst_cursor_t *cursor, bst_node_t *tree) {
+    cursor->depth = 0;
+    bst_cursor_descend(cursor, tree, false);
+    return cursor->depth > 0;
+}
+
+/*
+ * Nastaví kurzor na uzel s nejmenším klíčem větším nebo rovným key.
+ * Vrací false, pokud takový uzel ve stromu není.
+ */
+bool bst_cursor_seek(bst_cursor_t *cursor, bst_node_t *tree, char key) {
+    cursor->depth = 0;
+    // The closest greater key is the last node on the path where we turned left.
+    int found = 0;
+    while (tree != NULL) {
+        cursor->path[cursor->depth++] = tree;
+        if (key == tree->key) {
+            return true;
+        }
+        if (key < tree->key) {
+            found = cursor->depth;
+            tree = tree->left;
+        } else {
+            tree = tree->right;
+        }
+    }
+    cursor->depth = found;
+    return found > 0;
+}
+
+/*
+ * Posune kurzor na následující uzel v pořadí inorder. Vrací false, pokud
+ * už žádný není; kurzor je pak za koncem průchodu.
+ */
+bool bst_cursor_next(bst_cursor_t *cursor) {
+    if (cursor->depth == 0) {
+        return false;
+    }
+    bst_node_t *node = cursor->path[cursor->depth - 1];
+    if (node->right != NULL) {
+        bst_cursor_descend(cursor, node->right, true);
+        return true;
+    }
+    // Climb while we are a right child; the parent of the last left child is next.
+    while (--cursor->depth > 0 && cursor->path[cursor->depth - 1]->right == node) {
+        node = cursor->path[cursor->depth - 1];
+    }
+    return cursor->depth > 0;
+}
+
+/*
+ * Posune kurzor na předchozí uzel v pořadí inorder. Vrací false, pokud
+ * už žádný není; kurzor je pak za koncem průchodu.
+ */
+bool bst_cursor_prev(bst_cursor_t *cursor) {
+    if (cursor->depth == 0) {
+        return false;
+    }
+    bst_node_t *node = cursor->path[cursor->depth - 1];
+    if (node->left != NULL) {
+        bst_cursor_descend(cursor, node->left, false);
+        return true;
+    }
+    while (--cursor->depth > 0 && cursor->path[cursor->depth - 1]->left == node) {
+        node = cursor->path[cursor->depth - 1];
+    }
+    return cursor->depth > 0;
+}
+
+/*
+ * Aktuální uzel kurzoru, NULL za koncem průchodu.
+ */
+bst_node_t *bst_cursor_node(const bst_cursor_t *cursor) {
+    return cursor->depth > 0 ? cursor->path[cursor->depth - 1] : NULL;
+}
+
+/*
+ * Zavolá visit pro všechny uzly s klíčem v intervalu [lo, hi], vzestupně.
+ * Vrací false, pokud visit průchod ukončil.
+ */
+bool bst_range(bst_node_t *tree, char lo, char hi, bst_visitor_t visit, void *context) {
+    bst_cursor_t cursor;
+    for (bool ok = bst_cursor_seek(&cursor, tree, lo); ok; ok = bst_cursor_next(&cursor)) {
+        bst_node_t *node = bst_cursor_node(&cursor);
+        if (node->key > hi) {
+            break;
+        }
+        if (!visit(node, context)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,196 @@
+/*
+ * Binární vyhledávací strom — rozšíření
+ *
+ * Deklarace funkcí nad typy ze souboru btree.h, které nejsou součástí
+ * zadání.
+ */
+
+#ifndef IAL_BTREE_EXT_H
+#define IAL_BTREE_EXT_H
+
+#include "../btree.h"
+#include "btree_gen.h"
+#include "pool.h"
+#include <stdint.h>
+
+/*
+ * Alokace uzlů (btree_pool.c). Funkce bst_insert a bst_delete přidělují
+ * a uvolňují uzly přes bst_node_alloc a bst_node_free. Pokud vlákno nastaví
+ * pool funkcí bst_use_pool, berou se uzly z něj, jinak z malloc/free.
+ * Objekty poolu musí pojmout uzel použité varianty (bst_node_size), jinak
+ * přidělení selže.
+ *
+ * Pool patří jednomu stromu: dokud je nastavený, smí vlákno měnit jen
+ * stromy, jejichž uzly z něj pocházejí, a naopak se nesmí změnit (ani na
+ * NULL), dokud existuje strom s uzly z něj. Celý strom lze pak místo
+ * bst_dispose zrušit voláním pool_release a nastavením kořene na NULL.
+ */
+void bst_use_pool(pool_t *pool);
+bst_node_t *bst_node_alloc(void);
+bst_node_t *bst_node_alloc_size(size_t size);
+void bst_node_free(bst_node_t *node);
+
+/*
+ * Uzel vyvážené varianty (btree_avl.c). Začíná uzlem bst_node_t, takže
+ * funkce nad bst_node_t s ním pracují beze změny; navíc nese výšku
+ * a počet uzlů podstromu. Pool pro tuto variantu musí mít velikost objektu
+ * sizeof(bst_avl_node_t).
+ */
+typedef struct bst_avl_node {
+  bst_node_t node; // klíč, hodnota a potomci
+  int height;      // výška podstromu, list má výšku 1
+  int size;        // počet uzlů podstromu
+} bst_avl_node_t;
+
+/*
+ * Pořadové statistiky (jen btree_avl.c, využívají počty uzlů podstromů,
+ * O(log n)): bst_rank vrací počet klíčů menších než key, bst_select uzel
+ * s rank-tým nejmenším klíčem (od nuly) nebo NULL a bst_count_range počet
+ * klíčů v intervalu [lo, hi].
+ */
+size_t bst_rank(bst_node_t *tree, char key);
+bst_node_t *bst_select(bst_node_t *tree, size_t rank);
+size_t bst_count_range(bst_node_t *tree, char lo, char hi);
+
+/*
+ * Rozhraní, které každá varianta stromu (btree.c, btree_iter.c,
+ * btree_avl.c) poskytuje kódu, který sám přepojuje uzly (exa.c):
+ * bst_node_size je velikost uzlu varianty a bst_relinked přepočítá
+ * odvozené údaje uzlů (výšky u AVL) po přepojení celého stromu.
+ */
+extern const size_t bst_node_size;
+void bst_relinked(bst_node_t *tree);
+
+/*
+ * Hromadná stavba a vyvážení (exa.c). letter_count_scalar je referenční
+ * verze letter_count bez vektorových instrukcí, letter_count_parallel
+ * počítá v threads vláknech (0 = počet procesorů); výsledek je vždy
+ * stejný.
+ */
+bool bst_build_from_sorted(bst_node_t **tree, const char *keys, const int *values, size_t n);
+void letter_count_scalar(bst_node_t **tree, char *input);
+void letter_count_parallel(bst_node_t **tree, char *input, size_t threads);
+
+// Classes counted by letter_count: 'a'-'z', ' ' and '_' for everything else.
+#define LETTER_COUNT_CLASSES 28
+
+/*
+ * Průběžné počítání znaků po částech (exa.c). Vstup se předává jako
+ * (ukazatel, délka) libovolně mnoha voláními letter_counter_feed, nula
+ * je obyčejný znak; letter_counter_tree postaví ze dosavadních počtů
+ * stejný strom, jaký by vrátil letter_count pro celý vstup najednou.
+ *
+ * letter_count_fd a letter_count_file počítají obsah souboru nebo roury
+ * s pevnou spotřebou paměti bez ohledu na velikost vstupu. Při chybě
+ * vstupu vrací false (errno nastaví volání, které selhalo) a strom je
+ * prázdný.
+ */
+typedef struct letter_counter {
+  size_t counts[LETTER_COUNT_CLASSES]; // počty znaků podle tříd
+} letter_counter_t;
+
+void letter_counter_init(letter_counter_t *counter);
+void letter_counter_feed(letter_counter_t *counter, const char *data, size_t len);
+void letter_counter_tree(const letter_counter_t *counter, bst_node_t **tree);
+bool letter_count_fd(bst_node_t **tree, int fd);
+bool letter_count_file(bst_node_t **tree, const char *path);
+
+/*
+ * Stálá vlákna pro opakované paralelní počítání (exa.c). Vlákna poolu
+ * mezi úlohami spí a končí až v letter_count_pool_destroy, takže se
+ * jejich vytvoření neplatí při každém volání. letter_count_pool_run
+ * vrací stejný strom jako letter_count, letter_count_pool_feed přičte
+ * část vstupu do letter_counter_t. Pool smí v jednu chvíli používat jen
+ * jedno vlákno, které je zároveň jedním z pracovníků.
+ */
+typedef struct letter_count_pool {
+  struct letter_count_shared *shared; // stav sdílený vlákny poolu
+  size_t threads;                     // počet pracovníků včetně volajícího vlákna
+} letter_count_pool_t;
+
+bool letter_count_pool_init(letter_count_pool_t *pool, size_t threads);
+void letter_count_pool_destroy(letter_count_pool_t *pool);
+void letter_count_pool_run(letter_count_pool_t *pool, bst_node_t **tree, char *input);
+void letter_count_pool_feed(letter_count_pool_t *pool, letter_counter_t *counter, const char *data, size_t len);
+
+/*
+ * Počítání bez slučování znaků (exa.c) do generického stromu (btree_gen.h)
+ * s klíčem uint32_t a počtem size_t. letter_count_bytes počítá každou
+ * z 256 hodnot bajtu zvlášť (klíč 0-255), letter_count_utf8 počítá znaky
+ * (code points) textu v UTF-8 a neplatné posloupnosti jako U+FFFD, jejich
+ * počet vrací v *invalid. Při nedostatku paměti vrací false.
+ */
+BST_GEN(letter_tree, uint32_t, size_t, BST_GEN_CMP_NUM)
+
+bool letter_count_bytes(letter_tree_node_t **tree, const char *data, size_t len);
+bool letter_count_utf8(letter_tree_node_t **tree, const char *data, size_t len, size_t *invalid);
+
+// Keys are chars, so no tree has more than 256 nodes on one path.
+#define BST_CURSOR_DEPTH 256
+
+/*
+ * Kurzor pro postupný seřazený průchod (btree_cursor.c). Drží cestu od
+ * kořene k aktuálnímu uzlu v poli pevné velikosti, nic nealokuje. Změna
+ * stromu (vložení, smazání, vyvážení) kurzor zneplatní.
+ */
+typedef struct bst_cursor {
+  bst_node_t *path[BST_CURSOR_DEPTH]; // cesta od kořene, poslední je aktuální uzel
+  int depth;                          // délka cesty, 0 za koncem průchodu
+} bst_cursor_t;
+
+bool bst_cursor_first(bst_cursor_t *cursor, bst_node_t *tree);
+bool bst_cursor_last(bst_cursor_t *cursor, bst_node_t *tree);
+bool bst_cursor_seek(bst_cursor_t *cursor, bst_node_t *tree, char key);
+bool bst_cursor_next(bst_cursor_t *cursor);
+bool bst_cursor_prev(bst_cursor_t *cursor);
+bst_node_t *bst_cursor_node(const bst_cursor_t *cursor);
+
+/*
+ * Funkce volaná pro navštívený uzel; vrácením false průchod ukončí.
+ */
+typedef bool (*bst_visitor_t)(bst_node_t *node, void *context);
+
+bool bst_range(bst_node_t *tree, char lo, char hi, bst_visitor_t visit, void *context);
+
+/*
+ * Průchody s funkcí visit místo pole uzlů, v každé variantě stromu.
+ * Nic nealokují a vrácením false z visit skončí (funkce pak vrátí false).
+ * bst_size vrací počet uzlů: varianta AVL ho udržuje v kořeni, ostatní
+ * ho spočítají průchodem.
+ *
+ * bst_items_reserve (btree_pool.c) zvětší pole items tak, aby pojalo
+ * alespoň count uzlů; průchod do pole připraveného pro
+ * items->size + bst_size(tree) uzlů pak nealokuje. Vrací false při
+ * nedostatku paměti (pole zůstane beze změny).
+ */
+bool bst_preorder_visit(bst_node_t *tree, bst_visitor_t visit, void *context);
+bool bst_inorder_visit(bst_node_t *tree, bst_visitor_t visit, void *context);
+bool bst_postorder_visit(bst_node_t *tree, bst_visitor_t visit, void *context);
+size_t bst_size(bst_node_t *tree);
+bool bst_items_reserve(bst_items_t *items, size_t count);
+
+/*
+ * Průchody bez zásobníku a bez pomocné paměti (btree_morris.c), strom
+ * během nich dočasně mění ukazatele.
+ */
+void bst_preorder_morris(bst_node_t *tree, bst_items_t *items);
+void bst_inorder_morris(bst_node_t *tree, bst_items_t *items);
+void bst_postorder_morris(bst_node_t *tree, bst_items_t *items);
+
+/*
+ * Neměnný snímek stromu (btree_frozen.c): klíče a hodnoty v oddělených
+ * polích v pořadí Eytzingerové (kořen na indexu 1, potomci uzlu k na 2k
+ * a 2k + 1), index 0 se nepoužívá.
+ */
+typedef struct bst_frozen {
+  char *keys;   // klíče v pořadí Eytzingerové
+  int *values;  // hodnoty ke klíčům
+  size_t count; // počet klíčů
+} bst_frozen_t;
+
+bool bst_freeze(bst_node_t *tree, bst_frozen_t *frozen);
+bool bst_frozen_build(bst_frozen_t *frozen, const char *keys, const int *values, size_t n);
+bool bst_frozen_search(const bst_frozen_t *frozen, char key, int *value);
+void bst_frozen_dispose(bst_frozen_t *frozen);
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Binární vyhledávací strom — neměnný snímek
+ *
+ * bst_freeze uloží obsah stromu do dvou souvislých polí (klíče, hodnoty)
+ * v pořadí Eytzingerové: implicitní úplný strom, kde potomci pozice k jsou
+ * na pozicích 2k a 2k + 1. Hledání nepotřebuje ukazatele, v každém patře
+ * jen spočítá další index z výsledku porovnání (bez podmíněného skoku)
+ * a horní patra, která čte každé hledání, leží v jedné cache line.
+ *
+ * Pozice počítají pomocné funkce bst_gen_eytzinger_* z btree_gen.h.
+ * Klíče jsou typu char, takže pole klíčů má nejvýše 256 bajtů a vejde se
+ * do čtyř cache line; přednačítání (prefetch) tu proto není potřeba. Pro
+ * velké snímky s jinými klíči viz name_freeze v btree_gen.h.
+ *
+ * Změna původního stromu se do snímku nepromítne, snímek je třeba
+ * vytvořit znovu.
+ */
+
+#include "../btree.h"
+#include "btree_ext.h"
+#include "btree_gen.h"
+#include <stdlib.h>
+
+static bool bst_frozen_alloc(bst_frozen_t *frozen, size_t n) {
+    frozen->keys = (char *)malloc(n + 1);
+    frozen->values = (int *)malloc((n + 1) * sizeof(int));
+    frozen->count = n;
+    if (frozen->keys == NULL || frozen->values == NULL) {
+        bst_frozen_dispose(frozen);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Vytvoří snímek stromu tree. Strom se prochází kurzorem (seřazeně) a každý
+ * uzel se zapíše rovnou na svou pozici, bez pomocného pole. Při nedostatku
+ * paměti vrací false a snímek je prázdný.
+ */
+bool bst_freeze(bst_node_t *tree, bst_frozen_t *frozen) {
+    bst_cursor_t cursor;
+    size_t n = 0;
+    for (bool ok = bst_cursor_first(&cursor, tree); ok; ok = bst_cursor_next(&cursor)) {
+        n++;
+    }
+    if (!bst_frozen_alloc(frozen, n)) {
+        return false;
+    }
+    size_t k = bst_gen_eytzinger_first(n);
+    for (bool ok = bst_cursor_first(&cursor, tree); ok; ok = bst_cursor_next(&cursor)) {
+        frozen->keys[k] = bst_cursor_node(&cursor)->key;
+        frozen->values[k] = bst_cursor_node(&cursor)->value;
+        k = bst_gen_eytzinger_next(k, n);
+    }
+    return true;
+}
+
+/*
+ * Vytvoří snímek přímo z n klíčů seřazených vzestupně (bez opakování)
+ * a jejich hodnot, obdoba bst_build_from_sorted. Při nedostatku paměti
+ * vrací false a snímek je prázdný.
+ */
+bool bst_frozen_build(bst_frozen_t *frozen, const char *keys, const int *values, size_t n) {
+    if (!bst_frozen_alloc(frozen, n)) {
+        return false;
+    }
+    size_t k = bst_gen_eytzinger_first(n);
+    for (size_t i = 0; i < n; i++) {
+        frozen->keys[k] = keys[i];
+        frozen->values[k] = values[i];
+        k = bst_gen_eytzinger_next(k, n);
+    }
+    return true;
+}
+
+/*
+ * Vyhledání klíče ve snímku, se stejným významem jako bst_search.
+ */
+bool bst_frozen_search(const bst_frozen_t *frozen, char key, int *value) {
+    const char *keys = frozen->keys;
+    size_t n = frozen->count;
+    size_t k = 1;
+    while (k <= n) {
+        // Go right when the key is larger; compiles to setcc/adc, not a branch.
+        k = 2 * k + (keys[k] < key);
+    }
+    k = bst_gen_eytzinger_lower(k);
+    if (k == 0 || keys[k] != key) {
+        return false;
+    }
+    *value = frozen->values[k];
+    return true;
+}
+
+/*
+ * Uvolní snímek.
+ */
+void bst_frozen_dispose(bst_frozen_t *frozen) {
+    free(frozen->keys);
+    free(frozen->values);
+    frozen->keys = NULL;
+    frozen->values = NULL;
+    frozen->count = 0;
+}
@@ -0,0 +1,482 @@
+/*
+ * Binární vyhledávací strom — generická varianta
+ *
+ * Makro BST_GEN(name, key_t, value_t, cmp) vygeneruje pro zadaný typ klíče
+ * a hodnoty typ uzlu name_node_t, pole uzlů name_items_t a funkce se stejným
+ * významem jako v btree.h:
+ *
+ *   name_init, name_search, name_insert, name_delete, name_dispose,
+ *   name_preorder, name_inorder, name_postorder, name_add_node_to_items
+ *
+ * a navíc name_find, která vrací nalezený uzel (nebo NULL). name_insert
+ * vrací false, pokud se nepodařilo alokovat uzel; strom pak zůstane beze
+ * změny. name_build_from_sorted(tree, keys, values, n) postaví vyvážený
+ * strom z n vzestupně seřazených různých klíčů v čase O(n) (při nedostatku
+ * paměti vrací false a prázdný strom).
+ *
+ * Uzly nesou počet uzlů podstromu, takže pořadové statistiky běží v čase
+ * O(log n): name_rank(tree, key) vrací počet klíčů menších než key,
+ * name_select(tree, rank) uzel s rank-tým nejmenším klíčem (od nuly) nebo
+ * NULL a name_count_range(tree, lo, hi) počet klíčů v intervalu [lo, hi].
+ * name_range(tree, lo, hi, visit, context) zavolá visit vzestupně pro uzly
+ * v intervalu [lo, hi] a navštíví jen podstromy, které s ním mají průnik;
+ * vrácením false z visit průchod skončí (funkce pak vrátí false).
+ *
+ * name_freeze(tree, frozen) uloží strom do neměnného snímku name_frozen_t
+ * se souvislými poli klíčů a hodnot v pořadí Eytzingerové (jako
+ * btree_frozen.c); name_frozen_build ho postaví přímo ze seřazených polí.
+ * name_frozen_search hledá bez ukazatelů a bez podmíněných skoků a několik
+ * pater dopředu přednačítá cache line, do které hledání sestoupí.
+ * name_frozen_dispose snímek uvolní.
+ *
+ * cmp(a, b) je makro nebo funkce vracející zápornou hodnotu, nulu nebo
+ * kladnou hodnotu podle toho, zda je a menší, rovno nebo větší než b. Rozvine
+ * se přímo do sestupu stromem, takže celočíselné klíče se porovnávají bez
+ * volání funkce přes ukazatel. Strom se vyvažuje stejně jako btree_avl.c,
+ * hloubka rekurze je proto O(log n).
+ *
+ * Klíče i hodnoty se ukládají hodnotou. Řetězcové klíče (const char *)
+ * musí zůstat platné, dokud jsou ve stromu.
+ *
+ * Příklad:
+ *
+ *   BST_GEN(bst_u64, uint64_t, int, BST_GEN_CMP_NUM)
+ *   BST_GEN(bst_str, const char *, double, strcmp)
+ *
+ *   bst_u64_node_t *tree;
+ *   bst_u64_init(&tree);
+ *   bst_u64_insert(&tree, 42, 1);
+ */
+
+#ifndef IAL_BTREE_GEN_H
+#define IAL_BTREE_GEN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// Node allocator; define both before including this header to replace malloc/free.
+#ifndef BST_GEN_ALLOC
+#define BST_GEN_ALLOC(size) malloc(size)
+#define BST_GEN_FREE(ptr) free(ptr)
+#endif
+
+#if defined(__GNUC__)
+#define BST_GEN_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define BST_GEN_PREFETCH(address) ((void)(address))
+#endif
+// Eytzinger index multiplier that reaches the cache line the search visits a few levels down.
+#define BST_GEN_PREFETCH_AHEAD(key_t) (sizeof(key_t) < 64 ? 64 / sizeof(key_t) : 1)
+
+/*
+ * Pozice v implicitním stromu pořadí Eytzingerové s n pozicemi: první
+ * v pořadí inorder (0 pro prázdný strom) a následující (0 za poslední).
+ */
+static inline size_t bst_gen_eytzinger_first(size_t n) {
+    size_t k = n > 0 ? 1 : 0;
+    while (k > 0 && 2 * k <= n) {
+        k *= 2;
+    }
+    return k;
+}
+
+static inline size_t bst_gen_eytzinger_next(size_t k, size_t n) {
+    if (2 * k + 1 <= n) {
+        k = 2 * k + 1;
+        while (2 * k <= n) {
+            k *= 2;
+        }
+        return k;
+    }
+    while (k & 1) {
+        k >>= 1;
+    }
+    return k >> 1;
+}
+
+/*
+ * Z pozice, kde skončil sestup, spočítá pozici nejmenšího klíče většího
+ * nebo rovného hledanému (0, pokud žádný není): odebere pravé odbočky
+ * za poslední levou i tu levou.
+ */
+static inline size_t bst_gen_eytzinger_lower(size_t k) {
+#if defined(__GNUC__)
+    return k >> __builtin_ffsll((long long)~k);
+#else
+    while (k & 1) {
+        k >>= 1;
+    }
+    return k >> 1;
+#endif
+}
+
+// Three-way comparison for arithmetic keys.
+#define BST_GEN_CMP_NUM(a, b) (((a) > (b)) - ((a) < (b)))
+
+#define BST_GEN(name, key_t, value_t, cmp)                                                    \
+typedef struct name##_node {                                                                  \
+  key_t key;                  /* klíč */                                                      \
+  value_t value;              /* hodnota */                                                   \
+  int height;                 /* výška podstromu, list má výšku 1 */                          \
+  size_t size;                /* počet uzlů podstromu */                                      \
+  struct name##_node *left;   /* levý podstrom */                                             \
+  struct name##_node *right;  /* pravý podstrom */                                            \
+} name##_node_t;                                                                              \
+                                                                                              \
+typedef struct name##_items {                                                                 \
+  name##_node_t **nodes; /* pole uzlů v pořadí průchodu */                                    \
+  int capacity;          /* velikost pole */                                                  \
+  int size;              /* počet uzlů v poli */                                              \
+} name##_items_t;                                                                             \
+                                                                                              \
+static inline int name##_height(name##_node_t *tree) {                                        \
+    return tree != NULL ? tree->height : 0;                                                   \
+}                                                                                             \
+                                                                                              \
+static inline size_t name##_size(name##_node_t *tree) {                                       \
+    return tree != NULL ? tree->size : 0;                                                     \
+}                                                                                             \
+                                                                                              \
+static inline void name##_update(name##_node_t *tree) {                                       \
+    int left = name##_height(tree->left);                                                     \
+    int right = name##_height(tree->right);                                                   \
+    tree->height = (left > right ? left : right) + 1;                                         \
+    tree->size = name##_size(tree->left) + name##_size(tree->right) + 1;                      \
+}                                                                                             \
+                                                                                              \
+static inline name##_node_t *name##_rotate_right(name##_node_t *tree) {                       \
+    name##_node_t *pivot = tree->left;                                                        \
+    tree->left = pivot->right;                                                                \
+    pivot->right = tree;                                                                      \
+    name##_update(tree);                                                                      \
+    name##_update(pivot);                                                                     \
+    return pivot;                                                                             \
+}                                                                                             \
+                                                                                              \
+static inline name##_node_t *name##_rotate_left(name##_node_t *tree) {                        \
+    name##_node_t *pivot = tree->right;                                                       \
+    tree->right = pivot->left;                                                                \
+    pivot->left = tree;                                                                       \
+    name##_update(tree);                                                                      \
+    name##_update(pivot);                                                                     \
+    return pivot;                                                                             \
+}                                                                                             \
+                                                                                              \
+static inline name##_node_t *name##_rebalance(name##_node_t *tree) {                          \
+    int balance = name##_height(tree->left) - name##_height(tree->right);                     \
+    if (balance > 1) {                                                                        \
+        if (name##_height(tree->left->left) < name##_height(tree->left->right)) {             \
+            tree->left = name##_rotate_left(tree->left);                                      \
+        }                                                                                     \
+        return name##_rotate_right(tree);                                                     \
+    }                                                                                         \
+    if (balance < -1) {                                                                       \
+        if (name##_height(tree->right->right) < name##_height(tree->right->left)) {           \
+            tree->right = name##_rotate_right(tree->right);                                   \
+        }                                                                                     \
+        return name##_rotate_left(tree);                                                      \
+    }                                                                                         \
+    name##_update(tree);                                                                      \
+    return tree;                                                                              \
+}                                                                                             \
+                                                                                              \
+static inline void name##_init(name##_node_t **tree) {                                        \
+    *tree = NULL;                                                                             \
+}                                                                                             \
+                                                                                              \
+static inline name##_node_t *name##_find(name##_node_t *tree, key_t key) {                    \
+    while (tree != NULL) {                                                                    \
+        int c = cmp(key, tree->key);                                                          \
+        if (c == 0) {                                                                         \
+            return tree;                                                                      \
+        }                                                                                     \
+        tree = c < 0 ? tree->left : tree->right;                                              \
+    }                                                                                         \
+    return NULL;                                                                              \
+}                                                                                             \
+                                                                                              \
+static inline bool name##_search(name##_node_t *tree, key_t key, value_t *value) {            \
+    name##_node_t *node = name##_find(tree, key);                                             \
+    if (node == NULL) {                                                                       \
+        return false;                                                                         \
+    }                                                                                         \
+    *value = node->value;                                                                     \
+    return true;                                                                              \
+}                                                                                             \
+                                                                                              \
+static inline bool name##_insert(name##_node_t **tree, key_t key, value_t value) {            \
+    if (*tree == NULL) {                                                                      \
+        name##_node_t *node = (name##_node_t *)BST_GEN_ALLOC(sizeof(name##_node_t));          \
+        if (node == NULL) {                                                                   \
+            return false;                                                                     \
+        }                                                                                     \
+        node->key = key;                                                                      \
+        node->value = value;                                                                  \
+        node->height = 1;                                                                     \
+        node->size = 1;                                                                       \
+        node->left = NULL;                                                                    \
+        node->right = NULL;                                                                   \
+        *tree = node;                                                                         \
+        return true;                                                                          \
+    }                                                                                         \
+    int c = cmp(key, (*tree)->key);                                                           \
+    if (c == 0) {                                                                             \
+        (*tree)->value = value;                                                               \
+        return true;                                                                          \
+    }                                                                                         \
+    if (!name##_insert(c < 0 ? &(*tree)->left : &(*tree)->right, key, value)) {               \
+        return false;                                                                         \
+    }                                                                                         \
+    *tree = name##_rebalance(*tree);                                                          \
+    return true;                                                                              \
+}                                                                                             \
+                                                                                              \
+static inline void name##_replace_by_rightmost(name##_node_t *target, name##_node_t **tree) { \
+    if ((*tree)->right == NULL) {                                                             \
+        name##_node_t *rightmost = *tree;                                                     \
+        target->key = rightmost->key;                                                         \
+        target->value = rightmost->value;                                                     \
+        *tree = rightmost->left;                                                              \
+        BST_GEN_FREE(rightmost);                                                              \
+        return;                                                                               \
+    }                                                                                         \
+    name##_replace_by_rightmost(target, &(*tree)->right);                                     \
+    *tree = name##_rebalance(*tree);                                                          \
+}                                                                                             \
+                                                                                              \
+static inline void name##_delete(name##_node_t **tree, key_t key) {                           \
+    if (*tree == NULL) {                                                                      \
+        return;                                                                               \
+    }                                                                                         \
+    int c = cmp(key, (*tree)->key);                                                           \
+    if (c != 0) {                                                                             \
+        name##_delete(c < 0 ? &(*tree)->left : &(*tree)->right, key);                         \
+    } else if ((*tree)->left == NULL || (*tree)->right == NULL) {                             \
+        name##_node_t *victim = *tree;                                                        \
+        *tree = victim->left != NULL ? victim->left : victim->right;                          \
+        BST_GEN_FREE(victim);                                                                 \
+        return;                                                                               \
+    } else {                                                                                  \
+        name##_replace_by_rightmost(*tree, &(*tree)->left);                                   \
+    }                                                                                         \
+    *tree = name##_rebalance(*tree);                                                          \
+}                                                                                             \
+                                                                                              \
+static inline void name##_dispose(name##_node_t **tree) {                                     \
+    if (*tree == NULL) {                                                                      \
+        return;                                                                               \
+    }                                                                                         \
+    name##_dispose(&(*tree)->left);                                                           \
+    name##_dispose(&(*tree)->right);                                                          \
+    BST_GEN_FREE(*tree);                                                                      \
+    *tree = NULL;                                                                             \
+}                                                                                             \
+                                                                                              \
+static inline bool name##_build_range(name##_node_t **tree, const key_t *keys,                \
+                                      const value_t *values, size_t n) {                      \
+    *tree = NULL;                                                                             \
+    if (n == 0) {                                                                             \
+        return true;                                                                          \
+    }                                                                                         \
+    size_t mid = n / 2;                                                                       \
+    name##_node_t *node = (name##_node_t *)BST_GEN_ALLOC(sizeof(name##_node_t));              \
+    if (node == NULL) {                                                                       \
+        return false;                                                                         \
+    }                                                                                         \
+    node->key = keys[mid];                                                                    \
+    node->value = values[mid];                                                                \
+    node->right = NULL;                                                                       \
+    if (!name##_build_range(&node->left, keys, values, mid) ||                                \
+        !name##_build_range(&node->right, keys + mid + 1, values + mid + 1, n - mid - 1)) {   \
+        name##_dispose(&node->left);                                                          \
+        name##_dispose(&node->right);                                                         \
+        BST_GEN_FREE(node);                                                                   \
+        return false;                                                                         \
+    }                                                                                         \
+    name##_update(node);                                                                      \
+    *tree = node;                                                                             \
+    return true;                                                                              \
+}                                                                                             \
+                                                                                              \
+static inline bool name##_build_from_sorted(name##_node_t **tree, const key_t *keys,          \
+                                            const value_t *values, size_t n) {                \
+    return name##_build_range(tree, keys, values, n);                                         \
+}                                                                                             \
+                                                                                              \
+static inline size_t name##_rank(name##_node_t *tree, key_t key) {                            \
+    size_t rank = 0;                                                                          \
+    while (tree != NULL) {                                                                    \
+        if (cmp(key, tree->key) <= 0) {                                                       \
+            tree = tree->left;                                                                \
+        } else {                                                                              \
+            rank += name##_size(tree->left) + 1;                                              \
+            tree = tree->right;                                                               \
+        }                                                                                     \
+    }                                                                                         \
+    return rank;                                                                              \
+}                                                                                             \
+                                                                                              \
+static inline name##_node_t *name##_select(name##_node_t *tree, size_t rank) {                \
+    while (tree != NULL) {                                                                    \
+        size_t left = name##_size(tree->left);                                                \
+        if (rank == left) {                                                                   \
+            return tree;                                                                      \
+        }                                                                                     \
+        if (rank < left) {                                                                    \
+            tree = tree->left;                                                                \
+        } else {                                                                              \
+            rank -= left + 1;                                                                 \
+            tree = tree->right;                                                               \
+        }                                                                                     \
+    }                                                                                         \
+    return NULL;                                                                              \
+}                                                                                             \
+                                                                                              \
+static inline size_t name##_count_range(name##_node_t *tree, key_t lo, key_t hi) {            \
+    if (cmp(lo, hi) > 0) {                                                                    \
+        return 0;                                                                             \
+    }                                                                                         \
+    size_t below_hi = name##_rank(tree, hi) + (name##_find(tree, hi) != NULL);                \
+    return below_hi - name##_rank(tree, lo);                                                  \
+}                                                                                             \
+                                                                                              \
+typedef bool (*name##_visitor_t)(name##_node_t *node, void *context);                         \
+                                                                                              \
+static inline bool name##_range(name##_node_t *tree, key_t lo, key_t hi,                      \
+                                name##_visitor_t visit, void *context) {                      \
+    if (tree == NULL) {                                                                       \
+        return true;                                                                          \
+    }                                                                                         \
+    int above_lo = cmp(tree->key, lo) >= 0;                                                   \
+    int below_hi = cmp(tree->key, hi) <= 0;                                                   \
+    if (above_lo && !name##_range(tree->left, lo, hi, visit, context)) {                      \
+        return false;                                                                         \
+    }                                                                                         \
+    if (above_lo && below_hi && !visit(tree, context)) {                                      \
+        return false;                                                                         \
+    }                                                                                         \
+    return !below_hi || name##_range(tree->right, lo, hi, visit, context);                    \
+}                                                                                             \
+                                                                                              \
+typedef struct name##_frozen {                                                                \
+  key_t *keys;     /* klíče v pořadí Eytzingerové, index 0 se nepoužívá */                    \
+  value_t *values; /* hodnoty ke klíčům */                                                    \
+  size_t count;    /* počet klíčů */                                                          \
+} name##_frozen_t;                                                                            \
+                                                                                              \
+static inline void name##_frozen_dispose(name##_frozen_t *frozen) {                           \
+    free(frozen->keys);                                                                       \
+    free(frozen->values);                                                                     \
+    frozen->keys = NULL;                                                                      \
+    frozen->values = NULL;                                                                    \
+    frozen->count = 0;                                                                        \
+}                                                                                             \
+                                                                                              \
+static inline bool name##_frozen_alloc(name##_frozen_t *frozen, size_t n) {                   \
+    frozen->keys = (key_t *)malloc((n + 1) * sizeof(key_t));                                  \
+    frozen->values = (value_t *)malloc((n + 1) * sizeof(value_t));                            \
+    frozen->count = n;                                                                        \
+    if (frozen->keys == NULL || frozen->values == NULL) {                                     \
+        name##_frozen_dispose(frozen);                                                        \
+        return false;                                                                         \
+    }                                                                                         \
+    return true;                                                                              \
+}                                                                                             \
+                                                                                              \
+static inline size_t name##_frozen_fill(name##_node_t *tree, name##_frozen_t *frozen,         \
+                                        size_t k) {                                           \
+    if (tree == NULL) {                                                                       \
+        return k;                                                                             \
+    }                                                                                         \
+    k = name##_frozen_fill(tree->left, frozen, k);                                            \
+    frozen->keys[k] = tree->key;                                                              \
+    frozen->values[k] = tree->value;                                                          \
+    return name##_frozen_fill(tree->right, frozen, bst_gen_eytzinger_next(k, frozen->count)); \
+}                                                                                             \
+                                                                                              \
+static inline bool name##_freeze(name##_node_t *tree, name##_frozen_t *frozen) {              \
+    size_t n = name##_size(tree);                                                             \
+    if (!name##_frozen_alloc(frozen, n)) {                                                    \
+        return false;                                                                         \
+    }                                                                                         \
+    name##_frozen_fill(tree, frozen, bst_gen_eytzinger_first(n));                             \
+    return true;                                                                              \
+}                                                                                             \
+                                                                                              \
+static inline bool name##_frozen_build(name##_frozen_t *frozen, const key_t *keys,            \
+                                       const value_t *values, size_t n) {                     \
+    if (!name##_frozen_alloc(frozen, n)) {                                                    \
+        return false;                                                                         \
+    }                                                                                         \
+    size_t k = bst_gen_eytzinger_first(n);                                                    \
+    for (size_t i = 0; i < n; i++) {                                                          \
+        frozen->keys[k] = keys[i];                                                            \
+        frozen->values[k] = values[i];                                                        \
+        k = bst_gen_eytzinger_next(k, n);                                                     \
+    }                                                                                         \
+    return true;                                                                              \
+}                                                                                             \
+                                                                                              \
+static inline bool name##_frozen_search(const name##_frozen_t *frozen, key_t key,             \
+                                        value_t *value) {                                     \
+    const key_t *keys = frozen->keys;                                                         \
+    size_t n = frozen->count;                                                                 \
+    size_t k = 1;                                                                             \
+    while (k <= n) {                                                                          \
+        size_t ahead = k * BST_GEN_PREFETCH_AHEAD(key_t);                                     \
+        if (ahead <= n) {                                                                     \
+            BST_GEN_PREFETCH(keys + ahead);                                                   \
+        }                                                                                     \
+        k = 2 * k + (cmp(keys[k], key) < 0);                                                  \
+    }                                                                                         \
+    k = bst_gen_eytzinger_lower(k);                                                           \
+    if (k == 0 || cmp(keys[k], key) != 0) {                                                   \
+        return false;                                                                         \
+    }                                                                                         \
+    *value = frozen->values[k];                                                               \
+    return true;                                                                              \
+}                                                                                             \
+                                                                                              \
+static inline void name##_add_node_to_items(name##_node_t *node, name##_items_t *items) {     \
+    if (items->size == items->capacity) {                                                     \
+        int capacity = items->capacity ? items->capacity * 2 : 32;                            \
+        size_t bytes = (size_t)capacity * sizeof(name##_node_t *);                            \
+        name##_node_t **nodes = (name##_node_t **)realloc(items->nodes, bytes);               \
+        if (nodes == NULL) {                                                                  \
+            return;                                                                           \
+        }                                                                                     \
+        items->nodes = nodes;                                                                 \
+        items->capacity = capacity;                                                           \
+    }                                                                                         \
+    items->nodes[items->size++] = node;                                                       \
+}                                                                                             \
+                                                                                              \
+static inline void name##_preorder(name##_node_t *tree, name##_items_t *items) {              \
+    if (tree == NULL) {                                                                       \
+        return;                                                                               \
+    }                                                                                         \
+    name##_add_node_to_items(tree, items);                                                    \
+    name##_preorder(tree->left, items);                                                       \
+    name##_preorder(tree->right, items);                                                      \
+}                                                                                             \
+                                                                                              \
+static inline void name##_inorder(name##_node_t *tree, name##_items_t *items) {               \
+    if (tree == NULL) {                                                                       \
+        return;                                                                               \
+    }                                                                                         \
+    name##_inorder(tree->left, items);                                                        \
+    name##_add_node_to_items(tree, items);                                                    \
+    name##_inorder(tree->right, items);                                                       \
+}                                                                                             \
+                                                                                              \
+static inline void name##_postorder(name##_node_t *tree, name##_items_t *items) {             \
+    if (tree == NULL) {                                                                       \
+        return;                                                                               \
+    }                                                                                         \
+    name##_postorder(tree->left, items);                                                      \
+    name##_postorder(tree->right, items);                                                     \
+    name##_add_node_to_items(tree, items);                                                    \
+}
+
+#endif
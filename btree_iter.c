@@ -7,10 +7,25 @@
  */
 
 #include "../btree.h"
+#include "btree_ext.h"
+#include "stats.h"
 #include "stack.h"
 #include <stdio.h>
 #include <stdlib.h>
 
+/*
+ * Velikost uzlu této varianty (viz btree_ext.h).
+ */
+const size_t bst_node_size = sizeof(bst_node_t);
+
+/*
+ * Dokončení stromu, jehož uzly přepojil kód mimo tento soubor. Uzly této
+ * varianty nenesou žádné odvozené údaje, není tedy co přepočítat.
+ */
+void bst_relinked(bst_node_t *tree) {
+    (void)tree;
+}
+
 /*
  * Inicializace stromu.
  *
@@ -38,6 +53,7 @@ bool bst_search(bst_node_t *tree, char key, int *value) {
 
     // Iterate through the tree as long as the current node is not NULL.
     while (tree != NULL) {
+        STATS_STEP();
         // Check if the current node's key matches the search key.
         if (tree->key == key) {
             // If the key is found and value is not NULL, store the value in the provided address.
@@ -46,6 +62,7 @@ bool bst_search(bst_node_t *tree, char key, int *value) {
             }
             // Reset the tree pointer to the original root before returning.
             tree = tmp;
+            STATS_END(bst_search);
             return true;
         }
         // Move to the left or right child depending on the value of the key.
@@ -54,6 +71,7 @@ bool bst_search(bst_node_t *tree, char key, int *value) {
 
     // Reset the tree pointer to the original root before returning.
     tree = tmp;
+    STATS_END(bst_search);
     // Return false if the key is not found in the tree.
     return false;
 }
@@ -70,7 +88,12 @@ bool bst_search(bst_node_t *tree, char key, int *value) {
  * Funkci implementujte iterativně bez použití vlastních pomocných funkcí.
  */
 void bst_insert(bst_node_t **tree, char key, int value) {
-    bst_node_t *newNode = (bst_node_t *)malloc(sizeof(struct bst_node));
+    bst_node_t *newNode = bst_node_alloc();
+    // Out of memory (or a pool too small for the node): leave the tree unchanged.
+    if (newNode == NULL) {
+        STATS_END(bst_insert);
+        return;
+    }
     // Set the key and value of the new node.
     newNode->key = key;
     newNode->value = value;
@@ -81,6 +104,7 @@ void bst_insert(bst_node_t **tree, char key, int value) {
     // If the tree is empty, set the new node as the root and return.
     if ((*tree) == NULL) {
        (*tree) = newNode;
+       STATS_END(bst_insert);
        return;
     }
 
@@ -88,10 +112,11 @@ void bst_insert(bst_node_t **tree, char key, int value) {
     bst_node_t *tmp = *tree;
     // Iterate through the tree to find the correct position for the new node.
     while (tmp != NULL) {
+    STATS_STEP();
     // If a node with the same key is found, update its value and free the new node.
     if ((*tree)->key == key) {
         (*tree)->value = value;
-        free(newNode);
+        bst_node_free(newNode);
         break;
     }
 
@@ -118,6 +143,7 @@ void bst_insert(bst_node_t **tree, char key, int value) {
 }
     // Reset the tree pointer to the original root of the tree.
     *tree = tmp;
+    STATS_END(bst_insert);
 }
 
 /*
@@ -149,9 +175,12 @@ void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree) {
             // This step removes the rightmost node from the tree.
             if (par != NULL) {
                 par->right = cur->left;
+            } else {
+                // The subtree root itself is the rightmost node.
+                *tree = cur->left;
             }
             // Free the memory of the rightmost node and set the pointer to NULL.
-            free(cur);
+            bst_node_free(cur);
             cur = NULL;
             // Break out of the loop as the replacement is done.
             break;
@@ -183,6 +212,7 @@ void bst_delete(bst_node_t **tree, char key) {
 
     // Iterate through the tree as long as the current node is not NULL.
     while (cur) {
+        STATS_STEP();
         // Check if the current node's key matches the key to be deleted.
         if (key == cur->key) {
             // Case 1: Node with only right child or no child.
@@ -190,12 +220,14 @@ void bst_delete(bst_node_t **tree, char key) {
                 // If parent is NULL, it means cur is the root node.
                 if (par == NULL) {
                     *tree = cur->left;
-                } else {
-                    // Link the parent node to the left child of the current node.
+                } else if (par->left == cur) {
+                    // Link the parent node, on the side the current node hangs from, to its left child.
                     par->left = cur->left;
+                } else {
+                    par->right = cur->left;
                 }
                 // Free the memory of the current node and set it to NULL.
-                free(cur);
+                bst_node_free(cur);
                 cur = NULL;
             } else {
                 // Case 2: Node with only left child.
@@ -203,12 +235,14 @@ void bst_delete(bst_node_t **tree, char key) {
                     // If parent is NULL, it means cur is the root node.
                     if (par == NULL) {
                         *tree = cur->right;
+                    } else if (par->left == cur) {
+                        // Link the parent node, on the side the current node hangs from, to its right child.
+                        par->left = cur->right;
                     } else {
-                        // Link the parent node to the right child of the current node.
                         par->right = cur->right;
                     }
                     // Free the memory of the current node.
-                    free(cur);
+                    bst_node_free(cur);
                     cur = NULL;
                 } else {
                     // Case 3: Node with two children.
@@ -227,6 +261,7 @@ void bst_delete(bst_node_t **tree, char key) {
             cur = cur->right;
         }
     }
+    STATS_END(bst_delete);
 }
 
 /*
@@ -255,7 +290,7 @@ void bst_dispose(bst_node_t **tree) {
             }
             bst_node_t *tmp = *tree;
             *tree = (*tree)->left;
-            free(tmp);
+            bst_node_free(tmp);
         }
 
     } while ((*tree != NULL) || (!stack_bst_empty(&stack)));
@@ -379,3 +414,94 @@ void bst_postorder(bst_node_t *tree, bst_items_t *items) {
         }
     }
 }
+
+/*
+ * Počet uzlů stromu. Tato varianta počet neudržuje, projde proto celý
+ * strom se zásobníkem uzlů (bez alokace).
+ */
+size_t bst_size(bst_node_t *tree) {
+    size_t count = 0;
+    stack_bst_t stack;
+    stack_bst_init(&stack);
+    bst_leftmost_inorder(tree, &stack);
+    while (!stack_bst_empty(&stack)) {
+        tree = stack_bst_top(&stack);
+        stack_bst_pop(&stack);
+        count++;
+        bst_leftmost_inorder(tree->right, &stack);
+    }
+    return count;
+}
+
+/*
+ * Preorder průchod stromem s funkcí visit.
+ *
+ * Pro každý uzel zavolá visit(uzel, context); pokud visit vrátí false,
+ * průchod skončí a funkce vrátí false. Nic nealokuje, odložené pravé
+ * podstromy drží v zásobníku uzlů.
+ */
+bool bst_preorder_visit(bst_node_t *tree, bst_visitor_t visit, void *context) {
+    stack_bst_t stack;
+    stack_bst_init(&stack);
+    for (;;) {
+        while (tree != NULL) {
+            if (!visit(tree, context)) {
+                return false;
+            }
+            if (tree->right != NULL) {
+                stack_bst_push(&stack, tree->right);
+            }
+            tree = tree->left;
+        }
+        if (stack_bst_empty(&stack)) {
+            return true;
+        }
+        tree = stack_bst_top(&stack);
+        stack_bst_pop(&stack);
+    }
+}
+
+/*
+ * Inorder průchod stromem s funkcí visit (viz bst_preorder_visit).
+ */
+bool bst_inorder_visit(bst_node_t *tree, bst_visitor_t visit, void *context) {
+    stack_bst_t stack;
+    stack_bst_init(&stack);
+    bst_leftmost_inorder(tree, &stack);
+    while (!stack_bst_empty(&stack)) {
+        tree = stack_bst_top(&stack);
+        stack_bst_pop(&stack);
+        if (!visit(tree, context)) {
+            return false;
+        }
+        bst_leftmost_inorder(tree->right, &stack);
+    }
+    return true;
+}
+
+/*
+ * Postorder průchod stromem s funkcí visit (viz bst_preorder_visit).
+ */
+bool bst_postorder_visit(bst_node_t *tree, bst_visitor_t visit, void *context) {
+    stack_bst_t bst_stack;
+    stack_bool_t bool_stack;
+    stack_bst_init(&bst_stack);
+    stack_bool_init(&bool_stack);
+    bst_leftmost_postorder(tree, &bst_stack, &bool_stack);
+    while (!stack_bst_empty(&bst_stack)) {
+        tree = stack_bst_top(&bst_stack);
+        bool from_left = stack_bool_top(&bool_stack);
+        stack_bool_pop(&bool_stack);
+        if (from_left) {
+            // Left subtree done; the node waits on the stack for its right subtree.
+            stack_bool_push(&bool_stack, false);
+            bst_leftmost_postorder(tree->right, &bst_stack, &bool_stack);
+        } else {
+            stack_bst_pop(&bst_stack);
+            if (!visit(tree, context)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,137 @@
+/*
+ * Binární vyhledávací strom — průchody bez zásobníku (Morris)
+ *
+ * Průchody nepotřebují zásobník ani jinou pomocnou paměť: cestu zpět
+ * k předkovi si uloží dočasně do pravého ukazatele nejpravějšího uzlu
+ * levého podstromu (vlákno, thread) a po návratu ho vrátí na NULL. Každá
+ * hrana se projde nejvýše třikrát, průchod je tedy O(n) pro libovolný
+ * tvar stromu, i pro zdegenerovaný.
+ *
+ * Během průchodu je strom dočasně změněný, nesmí ho proto současně číst
+ * jiné vlákno. Po skončení je strom stejný jako před ním.
+ */
+
+#include "../btree.h"
+#include "btree_ext.h"
+
+/*
+ * Nejpravější uzel levého podstromu uzlu tree, nebo uzel, jehož pravý
+ * ukazatel už je vláknem zpět na tree.
+ */
+static inline bst_node_t *bst_morris_predecessor(bst_node_t *tree) {
+    bst_node_t *pred = tree->left;
+    while (pred->right != NULL && pred->right != tree) {
+        pred = pred->right;
+    }
+    return pred;
+}
+
+/*
+ * Inorder průchod stromem bez zásobníku.
+ *
+ * Pro aktuálně zpracovávaný uzel zavolá funkci bst_add_node_to_items.
+ */
+void bst_inorder_morris(bst_node_t *tree, bst_items_t *items) {
+    while (tree != NULL) {
+        if (tree->left == NULL) {
+            bst_add_node_to_items(tree, items);
+            tree = tree->right;
+            continue;
+        }
+        bst_node_t *pred = bst_morris_predecessor(tree);
+        if (pred->right == NULL) {
+            // First visit: thread back to tree and go left.
+            pred->right = tree;
+            tree = tree->left;
+        } else {
+            // Came back along the thread: the left subtree is done.
+            pred->right = NULL;
+            bst_add_node_to_items(tree, items);
+            tree = tree->right;
+        }
+    }
+}
+
+/*
+ * Preorder průchod stromem bez zásobníku.
+ *
+ * Pro aktuálně zpracovávaný uzel zavolá funkci bst_add_node_to_items.
+ */
+void bst_preorder_morris(bst_node_t *tree, bst_items_t *items) {
+    while (tree != NULL) {
+        if (tree->left == NULL) {
+            bst_add_node_to_items(tree, items);
+            tree = tree->right;
+            continue;
+        }
+        bst_node_t *pred = bst_morris_predecessor(tree);
+        if (pred->right == NULL) {
+            // Same walk as inorder, but the node is reported on the way down.
+            bst_add_node_to_items(tree, items);
+            pred->right = tree;
+            tree = tree->left;
+        } else {
+            pred->right = NULL;
+            tree = tree->right;
+        }
+    }
+}
+
+/*
+ * Obrátí pravé ukazatele na cestě from → to (to je dosažitelný z from po
+ * pravých potomcích a jeho pravý ukazatel je NULL). Pravý ukazatel from
+ * bude NULL, druhé volání s prohozenými konci cestu vrátí.
+ */
+static void bst_morris_reverse(bst_node_t *from, bst_node_t *to) {
+    bst_node_t *prev = NULL;
+    bst_node_t *node = from;
+    while (prev != to) {
+        bst_node_t *next = node->right;
+        node->right = prev;
+        prev = node;
+        node = next;
+    }
+}
+
+/*
+ * Zpracuje pravou větev from → to v obráceném pořadí (od to k from).
+ */
+static void bst_morris_visit_reversed(bst_node_t *from, bst_node_t *to, bst_items_t *items) {
+    bst_morris_reverse(from, to);
+    for (bst_node_t *node = to; node != NULL; node = node->right) {
+        bst_add_node_to_items(node, items);
+    }
+    bst_morris_reverse(to, from);
+}
+
+/*
+ * Postorder průchod stromem bez zásobníku.
+ *
+ * Pro aktuálně zpracovávaný uzel zavolá funkci bst_add_node_to_items.
+ * Pomocný kořen, jehož levým podstromem je celý strom, leží na zásobníku
+ * volání; po návratu z levého podstromu se pravá větev od levého potomka
+ * k předchůdci zpracuje pozpátku tak, že se dočasně otočí její ukazatele.
+ */
+void bst_postorder_morris(bst_node_t *tree, bst_items_t *items) {
+    if (tree == NULL) {
+        return;
+    }
+    bst_node_t dummy = {.left = tree, .right = NULL};
+    bst_node_t *node = &dummy;
+    while (node != NULL) {
+        if (node->left == NULL) {
+            node = node->right;
+            continue;
+        }
+        bst_node_t *pred = bst_morris_predecessor(node);
+        if (pred->right == NULL) {
+            pred->right = node;
+            node = node->left;
+        } else {
+            // The thread is cut first, so the branch ends in NULL as reversal expects.
+            pred->right = NULL;
+            bst_morris_visit_reversed(node->left, pred, items);
+            node = node->right;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * Binární vyhledávací strom — alokace uzlů
+ *
+ * Společná pro rekurzivní i iterativní variantu, viz btree_ext.h. Patří
+ * sem i předem alokované pole uzlů pro průchody.
+ */
+
+#include "btree_ext.h"
+#include "stats.h"
+#include <limits.h>
+#include <stdlib.h>
+
+// Pool used by this thread for tree nodes, NULL means malloc/free.
+static _Thread_local pool_t *bst_node_pool = NULL;
+
+/*
+ * Nastaví pool, ze kterého vlákno přiděluje uzly (NULL znamená malloc).
+ * Funkce bst_node_free vrací uzel tam, odkud se právě přiděluje, takže
+ * dokud existuje strom s uzly z jednoho zdroje, nesmí se pool změnit.
+ */
+void bst_use_pool(pool_t *pool) {
+    bst_node_pool = pool;
+}
+
+/*
+ * Přidělí paměť pro jeden uzel. Při nedostatku paměti vrací NULL.
+ */
+bst_node_t *bst_node_alloc(void) {
+    return bst_node_alloc_size(sizeof(struct bst_node));
+}
+
+/*
+ * Přidělí paměť pro uzel rozšířený o další položky (size bajtů). Jsou-li
+ * objekty nastaveného poolu menší než size, vrací NULL.
+ */
+bst_node_t *bst_node_alloc_size(size_t size) {
+    STATS_COUNT(bst_allocs, 1);
+    if (bst_node_pool != NULL) {
+        // A pool sized for the plain bst_node_t cannot hold the larger AVL node.
+        if (size > bst_node_pool->obj_size) {
+            return NULL;
+        }
+        return (bst_node_t *)pool_alloc(bst_node_pool);
+    }
+    return (bst_node_t *)malloc(size);
+}
+
+/*
+ * Uvolní uzel přidělený funkcí bst_node_alloc. Uzel musí pocházet z poolu,
+ * který je nastavený teď (nebo z malloc, není-li nastavený žádný).
+ */
+void bst_node_free(bst_node_t *node) {
+    if (bst_node_pool != NULL) {
+        pool_free(bst_node_pool, node);
+    } else {
+        free(node);
+    }
+}
+
+/*
+ * Zvětší pole items tak, aby pojalo alespoň count uzlů. Uzly v poli
+ * zůstanou; při nedostatku paměti vrací false a pole je beze změny.
+ */
+bool bst_items_reserve(bst_items_t *items, size_t count) {
+    if (count <= (size_t)items->capacity) {
+        return true;
+    }
+    // bst_items_t counts in int.
+    if (count > INT_MAX) {
+        return false;
+    }
+    bst_node_t **nodes = (bst_node_t **)realloc(items->nodes, count * sizeof(bst_node_t *));
+    if (nodes == NULL) {
+        return false;
+    }
+    items->nodes = nodes;
+    items->capacity = (int)count;
+    return true;
+}
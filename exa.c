@@ -8,9 +8,460 @@
  * 
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "../btree.h"
+#include "btree_ext.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Build with -DLETTER_COUNT_NO_SIMD to force the scalar classifier; -mavx2 selects 32-byte vectors.
+#if defined(__AVX2__) && !defined(LETTER_COUNT_NO_SIMD)
+#include <immintrin.h>
+#define LETTER_COUNT_AVX2 1
+#define LETTER_COUNT_WIDTH 32
+typedef __m256i letter_vec_t;
+#elif (defined(__SSE2__) || defined(_M_X64)) && !defined(LETTER_COUNT_NO_SIMD)
+#include <emmintrin.h>
+#define LETTER_COUNT_SSE2 1
+#define LETTER_COUNT_WIDTH 16
+typedef __m128i letter_vec_t;
+#else
+#define LETTER_COUNT_WIDTH 16
+#endif
+
+// UTF-8 validation looks bytes up with a shuffle (SSSE3, implied by -mavx2). Without -mssse3, GCC and
+// Clang on x86-64 still compile it for SSSE3 and letter_count_utf8 uses it when the CPU has it.
+#if (defined(LETTER_COUNT_AVX2) || defined(LETTER_COUNT_SSE2)) && defined(__SSSE3__)
+#include <tmmintrin.h>
+#define LETTER_UTF8_SIMD 1
+#define LETTER_UTF8_TARGET
+#elif defined(LETTER_COUNT_SSE2) && defined(__GNUC__) && defined(__x86_64__)
+#include <tmmintrin.h>
+#define LETTER_UTF8_SIMD 1
+#define LETTER_UTF8_DISPATCH 1
+#define LETTER_UTF8_TARGET __attribute__((target("ssse3")))
+#endif
+
+// Counted classes: letters 'a'-'z' fold to 0-25, then space and everything else.
+#define LETTER_COUNT_SPACE 26
+#define LETTER_COUNT_OTHER 27
+// Bytes per block: 8-bit lane counters take at most 255 vectors before they are summed.
+#define LETTER_COUNT_BLOCK (255 * LETTER_COUNT_WIDTH)
+// Classes counted per pass over a block, so that counters and keys stay in registers.
+#define LETTER_COUNT_GROUP 7
+// Bytes a worker thread claims at once: large enough to amortize the claim, small enough to balance load.
+#define LETTER_COUNT_CHUNK (1u << 20)
+// Per-thread histograms start on separate cache lines.
+#define LETTER_COUNT_LINE 64
+// Bytes of a file mapped at once; a multiple of any page size, and unmapped before the next window.
+#define LETTER_COUNT_WINDOW ((size_t)64 << 20)
+// Buffer for inputs that cannot be mapped (pipes, sockets, terminals).
+#define LETTER_COUNT_READ ((size_t)1 << 20)
+// Independent byte histograms, so that consecutive equal bytes do not wait on each other's increment.
+#define LETTER_COUNT_LANES 4
+// Code points below this are counted in a flat array, the rest directly in the tree.
+#define LETTER_COUNT_FLAT 0x10000
+// Invalid UTF-8 is counted as U+FFFD; the decoder reports it with a value no code point has.
+#define LETTER_COUNT_REPLACEMENT 0xFFFD
+#define LETTER_COUNT_INVALID UINT32_MAX
+
+/*
+ * Třída znaku c: 0-25 pro písmena bez ohledu na velikost, jinak
+ * LETTER_COUNT_SPACE nebo LETTER_COUNT_OTHER.
+ */
+static inline int letter_count_class(unsigned char c) {
+    // Setting bit 5 maps 'A'-'Z' onto 'a'-'z' and no other byte into that range.
+    unsigned letter = (unsigned)(c | 0x20) - 'a';
+    if (letter < 26) {
+        return (int)letter;
+    }
+    return c == ' ' ? LETTER_COUNT_SPACE : LETTER_COUNT_OTHER;
+}
+
+/*
+ * Přičte do counts třídy len bajtů od input, po jednom bajtu.
+ */
+static void letter_count_scalar_block(const unsigned char *input, size_t len, size_t counts[LETTER_COUNT_CLASSES]) {
+    for (size_t i = 0; i < len; i++) {
+        counts[letter_count_class(input[i])]++;
+    }
+}
+
+/*
+ * Maska bajtů z len (nejvýše LETTER_COUNT_WIDTH) bajtů od input, které
+ * nejsou ASCII; bit k odpovídá bajtu input[k].
+ */
+static inline uint32_t letter_count_high(const unsigned char *input, size_t len) {
+    uint32_t mask = 0;
+    for (size_t k = 0; k < len; k++) {
+        mask |= (uint32_t)(input[k] >> 7) << k;
+    }
+    return mask;
+}
+
+#if defined(LETTER_COUNT_AVX2) || defined(LETTER_COUNT_SSE2)
+
+// The group kernel must be expanded for each constant first class to keep its counters in registers.
+#if defined(__GNUC__)
+#define LETTER_COUNT_INLINE inline __attribute__((always_inline))
+#else
+#define LETTER_COUNT_INLINE inline
+#endif
+
+static inline letter_vec_t letter_vec_load(const unsigned char *input) {
+#ifdef LETTER_COUNT_AVX2
+    return _mm256_loadu_si256((const __m256i *)input);
+#else
+    return _mm_loadu_si128((const __m128i *)input);
+#endif
+}
+
+static inline letter_vec_t letter_vec_splat(unsigned char c) {
+#ifdef LETTER_COUNT_AVX2
+    return _mm256_set1_epi8((char)c);
+#else
+    return _mm_set1_epi8((char)c);
+#endif
+}
+
+/*
+ * Přičte k čítačům acc jedničku v bajtech, kde je data rovno key
+ * (porovnání dává -1, odečtením se tedy přičítá).
+ */
+static inline letter_vec_t letter_vec_count(letter_vec_t acc, letter_vec_t data, letter_vec_t key) {
+#ifdef LETTER_COUNT_AVX2
+    return _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(data, key));
+#else
+    return _mm_sub_epi8(acc, _mm_cmpeq_epi8(data, key));
+#endif
+}
+
+static inline letter_vec_t letter_vec_fold(letter_vec_t data) {
+#ifdef LETTER_COUNT_AVX2
+    return _mm256_or_si256(data, _mm256_set1_epi8(0x20));
+#else
+    return _mm_or_si128(data, _mm_set1_epi8(0x20));
+#endif
+}
+
+/*
+ * Maska bajtů vektoru od input, které nejsou ASCII (mají horní bit);
+ * bit k odpovídá bajtu input[k].
+ */
+static inline uint32_t letter_vec_high(const unsigned char *input) {
+#ifdef LETTER_COUNT_AVX2
+    return (uint32_t)_mm256_movemask_epi8(letter_vec_load(input));
+#else
+    return (uint32_t)_mm_movemask_epi8(letter_vec_load(input));
+#endif
+}
+
+/*
+ * Součet všech bajtových čítačů vektoru.
+ */
+static inline size_t letter_vec_sum(letter_vec_t acc) {
+#ifdef LETTER_COUNT_AVX2
+    __m256i sums = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+    return (size_t)_mm256_extract_epi64(sums, 0) + (size_t)_mm256_extract_epi64(sums, 1) +
+           (size_t)_mm256_extract_epi64(sums, 2) + (size_t)_mm256_extract_epi64(sums, 3);
+#else
+    __m128i sums = _mm_sad_epu8(acc, _mm_setzero_si128());
+    return (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_cvtsi128_si32(_mm_unpackhi_epi64(sums, sums));
+#endif
+}
+
+/*
+ * Spočítá třídy first až first + LETTER_COUNT_GROUP - 1 (nejvýše
+ * LETTER_COUNT_SPACE) ve vectors celých vektorech od input. Vrací počet
+ * započtených bajtů.
+ */
+static LETTER_COUNT_INLINE size_t letter_count_group(const unsigned char *input, size_t vectors, int first,
+                                      size_t counts[LETTER_COUNT_CLASSES]) {
+    letter_vec_t keys[LETTER_COUNT_GROUP];
+    letter_vec_t acc[LETTER_COUNT_GROUP];
+    for (int g = 0; g < LETTER_COUNT_GROUP; g++) {
+        int class = first + g;
+        keys[g] = letter_vec_splat(class < 26 ? (unsigned char)('a' + class) : ' ');
+        acc[g] = letter_vec_splat(0);
+    }
+    for (size_t v = 0; v < vectors; v++) {
+        letter_vec_t data = letter_vec_load(input + v * LETTER_COUNT_WIDTH);
+        letter_vec_t folded = letter_vec_fold(data);
+#if defined(__GNUC__)
+#pragma GCC unroll 8
+#endif
+        for (int g = 0; g < LETTER_COUNT_GROUP; g++) {
+            // Letters are matched case-folded, space as is: folding would also turn NUL into ' '.
+            acc[g] = letter_vec_count(acc[g], first + g < 26 ? folded : data, keys[g]);
+        }
+    }
+    size_t matched = 0;
+    for (int g = 0; g < LETTER_COUNT_GROUP && first + g <= LETTER_COUNT_SPACE; g++) {
+        size_t count = letter_vec_sum(acc[g]);
+        counts[first + g] += count;
+        matched += count;
+    }
+    return matched;
+}
+
+/*
+ * Přičte do counts třídy len bajtů od input (len nejvýše
+ * LETTER_COUNT_BLOCK). Celé vektory projde po skupinách tříd, ostatní
+ * znaky dopočítá z délky a zbytek za posledním vektorem projde po bajtech.
+ */
+static void letter_count_vector_block(const unsigned char *input, size_t len, size_t counts[LETTER_COUNT_CLASSES]) {
+    size_t vectors = len / LETTER_COUNT_WIDTH;
+    size_t matched = letter_count_group(input, vectors, 0, counts) +
+                     letter_count_group(input, vectors, LETTER_COUNT_GROUP, counts) +
+                     letter_count_group(input, vectors, 2 * LETTER_COUNT_GROUP, counts) +
+                     letter_count_group(input, vectors, 3 * LETTER_COUNT_GROUP, counts);
+    counts[LETTER_COUNT_OTHER] += vectors * LETTER_COUNT_WIDTH - matched;
+    letter_count_scalar_block(input + vectors * LETTER_COUNT_WIDTH, len % LETTER_COUNT_WIDTH, counts);
+}
+
+#else
+#define letter_count_vector_block letter_count_scalar_block
+
+static inline uint32_t letter_vec_high(const unsigned char *input) {
+    return letter_count_high(input, LETTER_COUNT_WIDTH);
+}
+#endif
+
+/*
+ * Spočítá třídy znaků řetězce input ukončeného nulou. Řetězec prochází po
+ * blocích: strnlen načte blok do cache a najde konec řetězce, počítání
+ * pak čte blok už z cache.
+ */
+static void letter_count_histogram(const char *input, size_t counts[LETTER_COUNT_CLASSES], bool vector) {
+    for (;;) {
+        size_t len = strnlen(input, LETTER_COUNT_BLOCK);
+        if (vector) {
+            letter_count_vector_block((const unsigned char *)input, len, counts);
+        } else {
+            letter_count_scalar_block((const unsigned char *)input, len, counts);
+        }
+        if (len < LETTER_COUNT_BLOCK) {
+            return;
+        }
+        input += len;
+    }
+}
+
+/*
+ * Přičte do counts třídy len bajtů od input. Nula v datech je obyčejný
+ * znak (třída LETTER_COUNT_OTHER).
+ */
+static void letter_count_buffer(const unsigned char *input, size_t len, size_t counts[LETTER_COUNT_CLASSES]) {
+    while (len > 0) {
+        size_t block = len < LETTER_COUNT_BLOCK ? len : LETTER_COUNT_BLOCK;
+        letter_count_vector_block(input, block, counts);
+        input += block;
+        len -= block;
+    }
+}
+
+/*
+ * Vstup sdílený vlákny paralelního letter_count. Vlákna si z něj berou
+ * úseky po LETTER_COUNT_CHUNK bajtech, dokud nějaké zbývají.
+ */
+typedef struct letter_count_job {
+    const unsigned char *input; // whole input
+    size_t len;                 // input length
+    atomic_size_t next;         // offset of the first unclaimed chunk
+} letter_count_job_t;
+
+typedef struct letter_count_worker {
+    _Alignas(LETTER_COUNT_LINE) size_t counts[LETTER_COUNT_CLASSES]; // this thread's histogram
+    letter_count_job_t *job;                                         // shared input
+    struct letter_count_shared *shared;                              // pool the worker belongs to
+    pthread_t thread;                                                // worker thread
+} letter_count_worker_t;
+
+/*
+ * Stav poolu sdílený jeho vlákny. Vlákna spí na start, dokud se nezvýší
+ * generation, a poslední z nich, které dopočítá úlohu, probudí volajícího
+ * přes done.
+ */
+typedef struct letter_count_shared {
+    pthread_mutex_t lock;           // guards generation, running and stop
+    pthread_cond_t start;           // signalled when a job is posted or the pool stops
+    pthread_cond_t done;            // signalled when the last worker finishes a job
+    uint64_t generation;            // number of jobs posted so far
+    size_t running;                 // workers still counting the current job
+    bool stop;                      // workers exit instead of waiting for the next job
+    letter_count_job_t job;         // current job
+    letter_count_worker_t *workers; // workers[0] is the calling thread, the rest own a thread
+} letter_count_shared_t;
+
+static void letter_count_work(letter_count_worker_t *self) {
+    letter_count_job_t *job = self->job;
+    for (;;) {
+        size_t start = atomic_fetch_add_explicit(&job->next, LETTER_COUNT_CHUNK, memory_order_relaxed);
+        if (start >= job->len) {
+            return;
+        }
+        size_t len = job->len - start < LETTER_COUNT_CHUNK ? job->len - start : LETTER_COUNT_CHUNK;
+        letter_count_buffer(job->input + start, len, self->counts);
+    }
+}
+
+static void *letter_count_pool_main(void *arg) {
+    letter_count_worker_t *self = (letter_count_worker_t *)arg;
+    letter_count_shared_t *shared = self->shared;
+    // No job can be posted before letter_count_pool_init returns, so the first one is generation 1.
+    uint64_t seen = 0;
+    pthread_mutex_lock(&shared->lock);
+    for (;;) {
+        while (!shared->stop && shared->generation == seen) {
+            pthread_cond_wait(&shared->start, &shared->lock);
+        }
+        if (shared->stop) {
+            break;
+        }
+        seen = shared->generation;
+        pthread_mutex_unlock(&shared->lock);
+        letter_count_work(self);
+        pthread_mutex_lock(&shared->lock);
+        if (--shared->running == 0) {
+            pthread_cond_signal(&shared->done);
+        }
+    }
+    pthread_mutex_unlock(&shared->lock);
+    return NULL;
+}
+
+/*
+ * Inicializace poolu s threads pracovníky včetně volajícího vlákna (0
+ * znamená počet procesorů). Vlákna, která nejde vytvořit, se vynechají
+ * a jejich práci udělají ostatní; pool->threads je skutečný počet. Při
+ * nedostatku paměti vrací false.
+ */
+bool letter_count_pool_init(letter_count_pool_t *pool, size_t threads) {
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    letter_count_shared_t *shared = (letter_count_shared_t *)calloc(1, sizeof(letter_count_shared_t));
+    letter_count_worker_t *workers =
+        (letter_count_worker_t *)aligned_alloc(LETTER_COUNT_LINE, threads * sizeof(letter_count_worker_t));
+    if (shared == NULL || workers == NULL) {
+        free(shared);
+        free(workers);
+        return false;
+    }
+    pthread_mutex_init(&shared->lock, NULL);
+    pthread_cond_init(&shared->start, NULL);
+    pthread_cond_init(&shared->done, NULL);
+    atomic_init(&shared->job.next, 0);
+    shared->workers = workers;
+    workers[0] = (letter_count_worker_t){.job = &shared->job, .shared = shared};
+    size_t started = 1;
+    // Worker 0 is the calling thread; a failed create leaves the slot to the next attempt.
+    for (size_t t = 1; t < threads; t++) {
+        workers[started] = (letter_count_worker_t){.job = &shared->job, .shared = shared};
+        if (pthread_create(&workers[started].thread, NULL, letter_count_pool_main, &workers[started]) == 0) {
+            started++;
+        }
+    }
+    pool->shared = shared;
+    pool->threads = started;
+    return true;
+}
+
+/*
+ * Ukončí vlákna poolu a uvolní ho.
+ */
+void letter_count_pool_destroy(letter_count_pool_t *pool) {
+    letter_count_shared_t *shared = pool->shared;
+    pthread_mutex_lock(&shared->lock);
+    shared->stop = true;
+    pthread_cond_broadcast(&shared->start);
+    pthread_mutex_unlock(&shared->lock);
+    for (size_t t = 1; t < pool->threads; t++) {
+        pthread_join(shared->workers[t].thread, NULL);
+    }
+    pthread_cond_destroy(&shared->done);
+    pthread_cond_destroy(&shared->start);
+    pthread_mutex_destroy(&shared->lock);
+    free(shared->workers);
+    free(shared);
+    pool->shared = NULL;
+    pool->threads = 0;
+}
+
+/*
+ * Přičte do counts třídy len bajtů od input pomocí vláken poolu. Každé
+ * vlákno počítá do vlastního histogramu a bere si další úsek, jakmile
+ * dokončí předchozí; na konci se histogramy sečtou do counts.
+ */
+static void letter_count_pool_histogram(letter_count_pool_t *pool, const unsigned char *input, size_t len,
+                                        size_t counts[LETTER_COUNT_CLASSES]) {
+    // A single chunk is not worth waking anybody.
+    if (pool->threads == 1 || len <= LETTER_COUNT_CHUNK) {
+        letter_count_buffer(input, len, counts);
+        return;
+    }
+    letter_count_shared_t *shared = pool->shared;
+    shared->job.input = input;
+    shared->job.len = len;
+    atomic_store_explicit(&shared->job.next, 0, memory_order_relaxed);
+    for (size_t t = 0; t < pool->threads; t++) {
+        memset(shared->workers[t].counts, 0, sizeof(shared->workers[t].counts));
+    }
+    // The mutex publishes the job to the workers and their histograms back to this thread.
+    pthread_mutex_lock(&shared->lock);
+    shared->generation++;
+    shared->running = pool->threads - 1;
+    pthread_cond_broadcast(&shared->start);
+    pthread_mutex_unlock(&shared->lock);
+
+    letter_count_work(&shared->workers[0]);
+
+    pthread_mutex_lock(&shared->lock);
+    while (shared->running > 0) {
+        pthread_cond_wait(&shared->done, &shared->lock);
+    }
+    pthread_mutex_unlock(&shared->lock);
+    for (size_t t = 0; t < pool->threads; t++) {
+        for (int class = 0; class < LETTER_COUNT_CLASSES; class++) {
+            counts[class] += shared->workers[t].counts[class];
+        }
+    }
+}
+
+/*
+ * Postaví ze spočítaných tříd vyvážený strom. Klíče jsou vzestupně
+ * ' ' < '_' < 'a' … 'z', třídy s nulovým počtem ve stromu nejsou. Počty
+ * nad INT_MAX se uloží jako INT_MAX.
+ */
+static void letter_count_build(bst_node_t **tree, const size_t counts[LETTER_COUNT_CLASSES]) {
+    char keys[LETTER_COUNT_CLASSES];
+    int values[LETTER_COUNT_CLASSES];
+    size_t n = 0;
+    static const int order[LETTER_COUNT_CLASSES] = {LETTER_COUNT_SPACE, LETTER_COUNT_OTHER, 0, 1, 2, 3, 4, 5, 6, 7,
+                                                    8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25};
+    for (int i = 0; i < LETTER_COUNT_CLASSES; i++) {
+        int class = order[i];
+        if (counts[class] == 0) {
+            continue;
+        }
+        keys[n] = class < 26 ? (char)('a' + class) : class == LETTER_COUNT_SPACE ? ' ' : '_';
+        values[n] = counts[class] > INT_MAX ? INT_MAX : (int)counts[class];
+        n++;
+    }
+    bst_build_from_sorted(tree, keys, values, n);
+}
 
 
 /**
@@ -30,92 +481,803 @@
  * '_'     5
  * 
  * Pro implementaci si můžete v tomto souboru nadefinovat vlastní pomocné funkce.
+ *
+ * Znaky se třídí po 16 (SSE2) nebo 32 (AVX2) bajtech najednou do plochého
+ * histogramu a strom se z něj postaví jednou na konci, rovnou vyvážený
+ * (bst_build_from_sorted). Na ostatních architekturách se třídí po bajtech.
 */
 void letter_count(bst_node_t **tree, char *input) {
-    // Array to keep track of character counts. Initialized to 0.
-    int value[256] = {[255] = 0};
-    // Initialize the BST.
+    // Count into a flat histogram first; the tree is built once, already balanced.
+    size_t counts[LETTER_COUNT_CLASSES] = {0};
     bst_init(tree);
-    // Loop through each character in the input string.
-    while (*input != '\0') {
-        // Determine the character to be counted.
-        char in = (*input <= 'z' && *input >= 'a') || *input == ' ' ? *input :
-                  (*input <= 'Z' && *input >= 'A') ? *input + ' ' : '_';
-        bst_insert(tree, in, ++value[(int)in]);
-        // Move to the next character in the input string.
-        input++;
+    letter_count_histogram(input, counts, true);
+    letter_count_build(tree, counts);
+}
+
+/*
+ * Paralelní letter_count pro velké vstupy se stejným výsledkem.
+ *
+ * Vstup rozdělí na úseky, které zpracuje threads vláken (0 znamená počet
+ * procesorů); každé vlákno si bere další úsek, jakmile dokončí předchozí.
+ * Vlákna počítají do vlastních histogramů a strom se postaví jednou po
+ * jejich sečtení. Délku řetězce zjistí předem jedním sekvenčním
+ * průchodem (strlen).
+ *
+ * Vlákna vytvoří a ukončí při každém volání; při opakovaném počítání je
+ * levnější jednou vytvořený pool a letter_count_pool_run.
+ */
+void letter_count_parallel(bst_node_t **tree, char *input, size_t threads) {
+    size_t counts[LETTER_COUNT_CLASSES] = {0};
+    size_t len = strlen(input);
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    // More threads than chunks would only idle.
+    size_t chunks = len / LETTER_COUNT_CHUNK + 1;
+    if (threads > chunks) {
+        threads = chunks;
     }
+    bst_init(tree);
+    letter_count_pool_t pool;
+    if (letter_count_pool_init(&pool, threads)) {
+        letter_count_pool_histogram(&pool, (const unsigned char *)input, len, counts);
+        letter_count_pool_destroy(&pool);
+    } else {
+        letter_count_buffer((const unsigned char *)input, len, counts);
+    }
+    letter_count_build(tree, counts);
 }
 
+/*
+ * letter_count_parallel s vlákny poolu pool.
+ */
+void letter_count_pool_run(letter_count_pool_t *pool, bst_node_t **tree, char *input) {
+    size_t counts[LETTER_COUNT_CLASSES] = {0};
+    bst_init(tree);
+    letter_count_pool_histogram(pool, (const unsigned char *)input, strlen(input), counts);
+    letter_count_build(tree, counts);
+}
 
+/*
+ * letter_counter_feed s vlákny poolu pool, pro velké části vstupu.
+ */
+void letter_count_pool_feed(letter_count_pool_t *pool, letter_counter_t *counter, const char *data, size_t len) {
+    letter_count_pool_histogram(pool, (const unsigned char *)data, len, counter->counts);
+}
 
-/**
- * Vyvážení stromu.
- * 
- * Vyvážený binární vyhledávací strom je takový binární strom, kde hloubka podstromů libovolného uzlu se od sebe liší maximálně o jedna.
- * 
- * Předpokládejte, že strom je alespoň inicializován. K získání uzlů stromu využijte vhodnou verzi vámi naimplmentovaného průchodu stromem.
- * Následně můžete například vytvořit nový strom, kde pořadím vkládaných prvků zajistíte vyváženost.
- *  
- * Pro implementaci si můžete v tomto souboru nadefinovat vlastní pomocné funkce. Není nutné, aby funkce fungovala *in situ* (in-place).
-*/
-int compare(const void *a, const void *b) {
-    return (*(char *)a - *(char *)b);
+/*
+ * Vynuluje počty znaků.
+ */
+void letter_counter_init(letter_counter_t *counter) {
+    memset(counter->counts, 0, sizeof(counter->counts));
 }
 
-void bst_balance(bst_node_t **tree) {
-    // Array to keep track of character counts.
-    int value[256] = {[255] = 0};
+/*
+ * Započte dalších len bajtů vstupu od data.
+ */
+void letter_counter_feed(letter_counter_t *counter, const char *data, size_t len) {
+    letter_count_buffer((const unsigned char *)data, len, counter->counts);
+}
+
+/*
+ * Postaví z dosavadních počtů vyvážený strom. Strom *tree se nejdřív
+ * inicializuje, stejně jako v letter_count.
+ */
+void letter_counter_tree(const letter_counter_t *counter, bst_node_t **tree) {
+    bst_init(tree);
+    letter_count_build(tree, counter->counts);
+}
+
+/*
+ * Započte size bajtů souboru fd po oknech LETTER_COUNT_WINDOW bajtů
+ * namapovaných do paměti. Pokud okno nejde namapovat, skončí dřív; pozici
+ * v souboru nastaví na první nezapočtený bajt.
+ */
+static void letter_count_mapped(letter_counter_t *counter, int fd, off_t size) {
+    off_t offset = 0;
+    while (offset < size) {
+        size_t len = (size_t)(size - offset) < LETTER_COUNT_WINDOW ? (size_t)(size - offset) : LETTER_COUNT_WINDOW;
+        void *window = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, offset);
+        if (window == MAP_FAILED) {
+            break;
+        }
+        // Read-ahead is only a hint, a failure does not matter.
+        posix_madvise(window, len, POSIX_MADV_SEQUENTIAL);
+        letter_counter_feed(counter, (const char *)window, len);
+        munmap(window, len);
+        offset += (off_t)len;
+    }
+    lseek(fd, offset, SEEK_SET);
+}
+
+/*
+ * Započte vše, co lze z fd přečíst, po LETTER_COUNT_READ bajtech.
+ */
+static bool letter_count_read(letter_counter_t *counter, int fd) {
+    char *buffer = (char *)malloc(LETTER_COUNT_READ);
+    if (buffer == NULL) {
+        return false;
+    }
+    for (;;) {
+        ssize_t len = read(fd, buffer, LETTER_COUNT_READ);
+        if (len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (len <= 0) {
+            free(buffer);
+            return len == 0;
+        }
+        letter_counter_feed(counter, buffer, (size_t)len);
+    }
+}
+
+/*
+ * Spočítá znaky obsahu otevřeného souboru fd od aktuální pozice do konce.
+ *
+ * Běžný soubor čte po oknech namapovaných do paměti s radou pro sekvenční
+ * čtení, ostatní vstupy (roury, terminál) velkými bloky funkcí read.
+ * Paměť je tedy omezená velikostí okna nebo bloku, ne velikostí vstupu.
+ * Popisovač fd nezavírá.
+ */
+bool letter_count_fd(bst_node_t **tree, int fd) {
+    letter_counter_t counter;
+    letter_counter_init(&counter);
+    bst_init(tree);
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        return false;
+    }
+    // Windows are mapped from offset 0, a descriptor positioned elsewhere is only read.
+    if (S_ISREG(info.st_mode) && info.st_size > 0 && lseek(fd, 0, SEEK_CUR) == 0) {
+        letter_count_mapped(&counter, fd, info.st_size);
+    }
+    // Whatever the mapping left (everything for pipes) is read.
+    if (!letter_count_read(&counter, fd)) {
+        return false;
+    }
+    letter_counter_tree(&counter, tree);
+    return true;
+}
+
+/*
+ * Spočítá znaky souboru path. Vrací false, pokud soubor nejde otevřít
+ * nebo přečíst.
+ */
+bool letter_count_file(bst_node_t **tree, const char *path) {
+    bst_init(tree);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = letter_count_fd(tree, fd);
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return ok;
+}
+
+/*
+ * Stejný výsledek jako letter_count, ale znaky třídí po jednom bez
+ * vektorových instrukcí. Slouží jako referenční verze pro porovnání.
+ */
+void letter_count_scalar(bst_node_t **tree, char *input) {
+    size_t counts[LETTER_COUNT_CLASSES] = {0};
+    bst_init(tree);
+    letter_count_histogram(input, counts, false);
+    letter_count_build(tree, counts);
+}
+
+/*
+ * Přičte počty bajtů z len bajtů od input do counts, střídavě do
+ * LETTER_COUNT_LANES dílčích histogramů.
+ */
+static void letter_count_byte_lanes(const unsigned char *input, size_t len,
+                                    size_t counts[LETTER_COUNT_LANES][256]) {
+    size_t i = 0;
+    for (; i + LETTER_COUNT_LANES <= len; i += LETTER_COUNT_LANES) {
+        for (int lane = 0; lane < LETTER_COUNT_LANES; lane++) {
+            counts[lane][input[i + lane]]++;
+        }
+    }
+    for (; i < len; i++) {
+        counts[0][input[i]]++;
+    }
+}
+
+/*
+ * Počet výskytů každé z 256 hodnot bajtu v len bajtech od data.
+ *
+ * Na rozdíl od letter_count nic neslučuje: klíčem stromu je hodnota bajtu
+ * 0-255 (bez znaménka), hodnotou počet výskytů. Při nedostatku paměti
+ * vrací false a prázdný strom.
+ */
+bool letter_count_bytes(letter_tree_node_t **tree, const char *data, size_t len) {
+    size_t lanes[LETTER_COUNT_LANES][256] = {{0}};
+    letter_count_byte_lanes((const unsigned char *)data, len, lanes);
+    uint32_t keys[256];
+    size_t values[256];
+    size_t n = 0;
+    for (uint32_t byte = 0; byte < 256; byte++) {
+        size_t count = 0;
+        for (int lane = 0; lane < LETTER_COUNT_LANES; lane++) {
+            count += lanes[lane][byte];
+        }
+        if (count > 0) {
+            keys[n] = byte;
+            values[n] = count;
+            n++;
+        }
+    }
+    letter_tree_init(tree);
+    return letter_tree_build_from_sorted(tree, keys, values, n);
+}
+
+/*
+ * Dekóduje jeden znak UTF-8 z len (alespoň 1) bajtů od input do *code.
+ * Vrací počet zpracovaných bajtů. Pro neplatnou posloupnost zapíše
+ * LETTER_COUNT_INVALID a přeskočí její nejdelší začátek, který by mohl
+ * být platný (alespoň jeden bajt), jak doporučuje standard Unicode.
+ * Zbytečně dlouhá kódování, náhradní páry (U+D800-U+DFFF) a znaky nad
+ * U+10FFFF jsou neplatné.
+ */
+static size_t letter_utf8_decode(const unsigned char *input, size_t len, uint32_t *code) {
+    unsigned char lead = input[0];
+    if (lead < 0x80) {
+        *code = lead;
+        return 1;
+    }
+    size_t need;
+    uint32_t value;
+    // Allowed range of the first continuation byte; it rules out overlong forms and surrogates.
+    unsigned char low = 0x80, high = 0xBF;
+    if (lead < 0xC2 || lead > 0xF4) {
+        *code = LETTER_COUNT_INVALID;
+        return 1;
+    } else if (lead < 0xE0) {
+        need = 1;
+        value = lead & 0x1F;
+    } else if (lead < 0xF0) {
+        need = 2;
+        value = lead & 0x0F;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+    } else {
+        need = 3;
+        value = lead & 0x07;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+    }
+    for (size_t k = 1; k <= need; k++) {
+        if (k >= len || input[k] < low || input[k] > high) {
+            *code = LETTER_COUNT_INVALID;
+            return k;
+        }
+        value = value << 6 | (input[k] & 0x3F);
+        low = 0x80;
+        high = 0xBF;
+    }
+    *code = value;
+    return need + 1;
+}
+
+/*
+ * Pozice nejnižšího nastaveného bitu nenulové masky.
+ */
+static inline size_t letter_count_lowest(uint32_t mask) {
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctz(mask);
+#else
+    size_t bit = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/*
+ * Přičte jedničku znaku code: pod LETTER_COUNT_FLAT do pole flat, jinak
+ * do stromu *rare. Vrací false při nedostatku paměti.
+ */
+static bool letter_utf8_add(size_t *flat, letter_tree_node_t **rare, uint32_t code) {
+    if (code < LETTER_COUNT_FLAT) {
+        flat[code]++;
+        return true;
+    }
+    letter_tree_node_t *node = letter_tree_find(*rare, code);
+    if (node != NULL) {
+        node->value++;
+        return true;
+    }
+    return letter_tree_insert(rare, code, 1);
+}
+
+typedef struct letter_utf8_sorted {
+    uint32_t *keys; // code points in ascending order
+    size_t *values; // their counts
+    size_t n;       // entries filled
+} letter_utf8_sorted_t;
+
+static bool letter_utf8_append(letter_tree_node_t *node, void *context) {
+    letter_utf8_sorted_t *sorted = (letter_utf8_sorted_t *)context;
+    sorted->keys[sorted->n] = node->key;
+    sorted->values[sorted->n] = node->value;
+    sorted->n++;
+    return true;
+}
+
+/*
+ * Postaví *tree z počtů v poli flat a ve stromu rare (ten obsahuje jen
+ * znaky od LETTER_COUNT_FLAT výš, navazuje tedy za polem).
+ */
+static bool letter_utf8_build(letter_tree_node_t **tree, const size_t *flat, letter_tree_node_t *rare) {
+    size_t n = letter_tree_size(rare);
+    for (uint32_t code = 0; code < LETTER_COUNT_FLAT; code++) {
+        n += flat[code] > 0;
+    }
+    // One spare entry keeps malloc from being asked for zero bytes.
+    letter_utf8_sorted_t sorted = {
+        .keys = (uint32_t *)malloc(n * sizeof(uint32_t) + 1),
+        .values = (size_t *)malloc(n * sizeof(size_t) + 1),
+    };
+    bool ok = sorted.keys != NULL && sorted.values != NULL;
+    if (ok) {
+        for (uint32_t code = 0; code < LETTER_COUNT_FLAT; code++) {
+            if (flat[code] > 0) {
+                sorted.keys[sorted.n] = code;
+                sorted.values[sorted.n] = flat[code];
+                sorted.n++;
+            }
+        }
+        letter_tree_range(rare, LETTER_COUNT_FLAT, LETTER_COUNT_INVALID, letter_utf8_append, &sorted);
+        ok = letter_tree_build_from_sorted(tree, sorted.keys, sorted.values, n);
+    }
+    free(sorted.keys);
+    free(sorted.values);
+    return ok;
+}
+
+/*
+ * Přičte znaky bajtů [start, end) od input (celý vstup má len bajtů) po
+ * jednom: najde bajty s horním bitem a dekóduje posloupnost, která takovým
+ * bajtem začíná. Neplatné posloupnosti počítá jako U+FFFD a přičítá je do
+ * *bad. *next je první bajt za posledním dekódovaným znakem. Při
+ * nedostatku paměti vrací false.
+ */
+static bool letter_utf8_count_block(const unsigned char *input, size_t start, size_t end, size_t len, size_t *next,
+                                    size_t *flat, letter_tree_node_t **rare, size_t *bad) {
+    bool ok = true;
+    for (size_t v = start; ok && v < end; v += LETTER_COUNT_WIDTH) {
+        size_t n = end - v < LETTER_COUNT_WIDTH ? end - v : LETTER_COUNT_WIDTH;
+        uint32_t high = n == LETTER_COUNT_WIDTH ? letter_vec_high(input + v) : letter_count_high(input + v, n);
+        while (ok && high != 0) {
+            size_t at = v + letter_count_lowest(high);
+            high &= high - 1;
+            if (at < *next) {
+                // Continuation byte of the sequence decoded last.
+                continue;
+            }
+            uint32_t code;
+            *next = at + letter_utf8_decode(input + at, len - at, &code);
+            if (code == LETTER_COUNT_INVALID) {
+                code = LETTER_COUNT_REPLACEMENT;
+                (*bad)++;
+            }
+            ok = letter_utf8_add(flat, rare, code);
+        }
+    }
+    return ok;
+}
 
-    // Variable to keep track of the number of unique characters in the tree.
-    unsigned size = 0;
+#ifdef LETTER_UTF8_SIMD
+// Error bits of the lookup tables, after Keiser and Lemire, "Validating UTF-8 In Less Than One
+// Instruction Per Byte" (2021). A byte pair is invalid when all three lookups share a bit.
+#define LETTER_UTF8_TOO_SHORT (1 << 0)      // lead byte not followed by a continuation
+#define LETTER_UTF8_TOO_LONG (1 << 1)       // continuation byte after an ASCII byte
+#define LETTER_UTF8_OVERLONG_3 (1 << 2)     // E0 followed by 80-9F
+#define LETTER_UTF8_TOO_LARGE (1 << 3)      // F4 followed by 90-BF, or F5-FF
+#define LETTER_UTF8_SURROGATE (1 << 4)      // ED followed by A0-BF
+#define LETTER_UTF8_OVERLONG_2 (1 << 5)     // C0 or C1
+#define LETTER_UTF8_TOO_LARGE_1000 (1 << 6) // F5-FF followed by 80-8F
+#define LETTER_UTF8_OVERLONG_4 (1 << 6)     // F0 followed by 80-8F
+#define LETTER_UTF8_TWO_CONTS (1 << 7)      // continuation byte after a continuation byte
+#define LETTER_UTF8_CARRY (LETTER_UTF8_TOO_SHORT | LETTER_UTF8_TOO_LONG | LETTER_UTF8_TWO_CONTS)
 
-    // Dynamically allocate memory for storing characters.
-    char *chars = (char *)malloc(sizeof(char) + 2);
+/*
+ * Chyby kódování ve vektoru input, kterému ve vstupu předchází vektor
+ * prev: nenulový bajt výsledku znamená neplatnou posloupnost. Chybějící
+ * pokračovací bajty na konci vektoru se projeví až v dalším vektoru.
+ */
+LETTER_UTF8_TARGET static inline __m128i letter_utf8_check(__m128i input, __m128i prev) {
+    const __m128i byte_1_high = _mm_setr_epi8(
+        // 0xxx: ASCII; 10xx: continuation; 1100-1101: two byte lead; 1110: three; 1111: four.
+        LETTER_UTF8_TOO_LONG, LETTER_UTF8_TOO_LONG, LETTER_UTF8_TOO_LONG, LETTER_UTF8_TOO_LONG,
+        LETTER_UTF8_TOO_LONG, LETTER_UTF8_TOO_LONG, LETTER_UTF8_TOO_LONG, LETTER_UTF8_TOO_LONG,
+        (char)LETTER_UTF8_TWO_CONTS, (char)LETTER_UTF8_TWO_CONTS, (char)LETTER_UTF8_TWO_CONTS,
+        (char)LETTER_UTF8_TWO_CONTS, LETTER_UTF8_TOO_SHORT | LETTER_UTF8_OVERLONG_2, LETTER_UTF8_TOO_SHORT,
+        LETTER_UTF8_TOO_SHORT | LETTER_UTF8_OVERLONG_3 | LETTER_UTF8_SURROGATE,
+        (char)(LETTER_UTF8_TOO_SHORT | LETTER_UTF8_TOO_LARGE | LETTER_UTF8_TOO_LARGE_1000 | LETTER_UTF8_OVERLONG_4));
+    const __m128i byte_1_low = _mm_setr_epi8(
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_OVERLONG_3 | LETTER_UTF8_OVERLONG_2 | LETTER_UTF8_OVERLONG_4),
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_OVERLONG_2), (char)LETTER_UTF8_CARRY, (char)LETTER_UTF8_CARRY,
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_TOO_LARGE),
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_TOO_LARGE | LETTER_UTF8_TOO_LARGE_1000),
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_TOO_LARGE | LETTER_UTF8_TOO_LARGE_1000),
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_TOO_LARGE | LETTER_UTF8_TOO_LARGE_1000),
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_TOO_LARGE | LETTER_UTF8_TOO_LARGE_1000),
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_TOO_LARGE | LETTER_UTF8_TOO_LARGE_1000),
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_TOO_LARGE | LETTER_UTF8_TOO_LARGE_1000),
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_TOO_LARGE | LETTER_UTF8_TOO_LARGE_1000),
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_TOO_LARGE | LETTER_UTF8_TOO_LARGE_1000),
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_TOO_LARGE | LETTER_UTF8_TOO_LARGE_1000 | LETTER_UTF8_SURROGATE),
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_TOO_LARGE | LETTER_UTF8_TOO_LARGE_1000),
+        (char)(LETTER_UTF8_CARRY | LETTER_UTF8_TOO_LARGE | LETTER_UTF8_TOO_LARGE_1000));
+    const __m128i byte_2_high = _mm_setr_epi8(
+        LETTER_UTF8_TOO_SHORT, LETTER_UTF8_TOO_SHORT, LETTER_UTF8_TOO_SHORT, LETTER_UTF8_TOO_SHORT,
+        LETTER_UTF8_TOO_SHORT, LETTER_UTF8_TOO_SHORT, LETTER_UTF8_TOO_SHORT, LETTER_UTF8_TOO_SHORT,
+        (char)(LETTER_UTF8_TOO_LONG | LETTER_UTF8_OVERLONG_2 | LETTER_UTF8_TWO_CONTS | LETTER_UTF8_OVERLONG_3 |
+               LETTER_UTF8_TOO_LARGE_1000 | LETTER_UTF8_OVERLONG_4),
+        (char)(LETTER_UTF8_TOO_LONG | LETTER_UTF8_OVERLONG_2 | LETTER_UTF8_TWO_CONTS | LETTER_UTF8_OVERLONG_3 |
+               LETTER_UTF8_TOO_LARGE),
+        (char)(LETTER_UTF8_TOO_LONG | LETTER_UTF8_OVERLONG_2 | LETTER_UTF8_TWO_CONTS | LETTER_UTF8_SURROGATE |
+               LETTER_UTF8_TOO_LARGE),
+        (char)(LETTER_UTF8_TOO_LONG | LETTER_UTF8_OVERLONG_2 | LETTER_UTF8_TWO_CONTS | LETTER_UTF8_SURROGATE |
+               LETTER_UTF8_TOO_LARGE),
+        LETTER_UTF8_TOO_SHORT, LETTER_UTF8_TOO_SHORT, LETTER_UTF8_TOO_SHORT, LETTER_UTF8_TOO_SHORT);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
 
-    // Iterate over the ASCII characters (up to 126).
-    for (char i = 0; i < 126; ++i) {
-        // Check if the character is in the tree and get its frequency.
-        if (bst_search(*tree, i, &value[(int)i])) {
-            // If the character is found, add it to the chars array and increase its size.
-            chars[size++] = i;
-            chars = (char *)realloc(chars, sizeof(char) * size + 2);
+    // The bytes one, two and three positions back, reaching into prev.
+    __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+    __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+    __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+    __m128i special = _mm_and_si128(
+        _mm_and_si128(_mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                      _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble))),
+        _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+    // A continuation two bytes after a three or four byte lead, or three after a four byte lead, is
+    // required; the pair check flags it as TWO_CONTS, which this cancels out.
+    __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+    __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+    __m128i must = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8((char)0x80));
+    return _mm_xor_si128(must, special);
+}
+
+/*
+ * Ověří, že len bajtů od input je platné UTF-8 a poslední znak není
+ * useknutý. Do *ascii zapíše, jestli jsou všechny bajty ASCII.
+ */
+LETTER_UTF8_TARGET static bool letter_utf8_valid(const unsigned char *input, size_t len, bool *ascii) {
+    // Bytes at or above these in the last positions of a vector start a sequence it does not finish.
+    const __m128i open = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                       (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+    __m128i prev = _mm_setzero_si128();
+    __m128i error = _mm_setzero_si128();
+    __m128i high = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m128i data[4];
+        for (int k = 0; k < 4; k++) {
+            data[k] = _mm_loadu_si128((const __m128i *)(input + i + 16 * k));
         }
+        __m128i any = _mm_or_si128(_mm_or_si128(data[0], data[1]), _mm_or_si128(data[2], data[3]));
+        if (_mm_movemask_epi8(any) == 0) {
+            // ASCII only: the one thing that can go wrong is a sequence left open before it.
+            error = _mm_or_si128(error, _mm_subs_epu8(prev, open));
+        } else {
+            high = any;
+            for (int k = 0; k < 4; k++) {
+                error = _mm_or_si128(error, letter_utf8_check(data[k], prev));
+                prev = data[k];
+            }
+            continue;
+        }
+        prev = data[3];
+    }
+    for (; i + 16 <= len; i += 16) {
+        __m128i data = _mm_loadu_si128((const __m128i *)(input + i));
+        high = _mm_or_si128(high, data);
+        error = _mm_or_si128(error, letter_utf8_check(data, prev));
+        prev = data;
+    }
+    // At least one zero follows the last byte, so a sequence cut short there is caught as well.
+    unsigned char tail[16] = {0};
+    memcpy(tail, input + i, len - i);
+    __m128i data = _mm_loadu_si128((const __m128i *)tail);
+    high = _mm_or_si128(high, data);
+    error = _mm_or_si128(error, letter_utf8_check(data, prev));
+    *ascii = _mm_movemask_epi8(high) == 0;
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+// Slots of flat that no character can use (surrogates) serve decode_vec as scratch space: one slot per
+// position for the bytes that do not start a character counted there, then LETTER_COUNT_LANES copies of
+// the ASCII range, so that increments of the same slot rarely wait on each other.
+#define LETTER_UTF8_UNUSED 0xD800
+#define LETTER_UTF8_ASCII (LETTER_UTF8_UNUSED + 16)
+#define LETTER_UTF8_SCRATCH (16 + LETTER_COUNT_LANES * 0x80)
+
+/*
+ * Index do flat pro každý z 16 bajtů b0: úvodní bajt dvou- a tříbajtové
+ * posloupnosti číslo znaku, bajt ASCII jeho místo v kopii
+ * LETTER_UTF8_ASCII podle pozice, ostatní bajty (pokračovací a úvodní
+ * bajty čtyřbajtových posloupností) nepoužité místo LETTER_UTF8_UNUSED +
+ * pozice. b1 a b2 jsou tytéž bajty posunuté o jeden a dva, vstup musí být
+ * platné UTF-8.
+ */
+static inline void letter_utf8_decode_vec(__m128i b0, __m128i b1, __m128i b2, uint16_t codes[16]) {
+    // Signed, a byte is ASCII from 0, a lead byte of two or three from -64 up to -17, of three from -32.
+    __m128i is_ascii = _mm_cmpgt_epi8(b0, _mm_set1_epi8(-1));
+    __m128i is_lead = _mm_and_si128(_mm_cmpgt_epi8(b0, _mm_set1_epi8(-65)), _mm_cmpgt_epi8(_mm_set1_epi8(-16), b0));
+    __m128i is_three = _mm_cmpgt_epi8(b0, _mm_set1_epi8(-33));
+    for (int half = 0; half < 2; half++) {
+        __m128i c0 = half ? _mm_unpackhi_epi8(b0, _mm_setzero_si128()) : _mm_unpacklo_epi8(b0, _mm_setzero_si128());
+        __m128i c1 = half ? _mm_unpackhi_epi8(b1, _mm_setzero_si128()) : _mm_unpacklo_epi8(b1, _mm_setzero_si128());
+        __m128i c2 = half ? _mm_unpackhi_epi8(b2, _mm_setzero_si128()) : _mm_unpacklo_epi8(b2, _mm_setzero_si128());
+        __m128i ascii = half ? _mm_unpackhi_epi8(is_ascii, is_ascii) : _mm_unpacklo_epi8(is_ascii, is_ascii);
+        __m128i lead = half ? _mm_unpackhi_epi8(is_lead, is_lead) : _mm_unpacklo_epi8(is_lead, is_lead);
+        __m128i three = half ? _mm_unpackhi_epi8(is_three, is_three) : _mm_unpacklo_epi8(is_three, is_three);
+        // 110xxxxx 10yyyyyy and 1110xxxx 10yyyyyy 10zzzzzz: the marker bits are subtracted and the
+        // lead byte shifted by 12 drops them on its own (16-bit lanes wrap around).
+        __m128i code2 = _mm_sub_epi16(_mm_add_epi16(_mm_slli_epi16(c0, 6), c1), _mm_set1_epi16(0x3080));
+        __m128i code3 = _mm_sub_epi16(_mm_add_epi16(_mm_slli_epi16(c0, 12), _mm_add_epi16(_mm_slli_epi16(c1, 6), c2)),
+                                      _mm_set1_epi16(0x2080));
+        __m128i code = _mm_or_si128(_mm_and_si128(three, code3), _mm_andnot_si128(three, code2));
+        __m128i unused = _mm_add_epi16(_mm_set1_epi16((short)(LETTER_UTF8_UNUSED + 8 * half)),
+                                       _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7));
+        code = _mm_or_si128(_mm_and_si128(lead, code), _mm_andnot_si128(lead, unused));
+        __m128i lanes = _mm_add_epi16(_mm_add_epi16(c0, _mm_set1_epi16((short)LETTER_UTF8_ASCII)),
+                                      _mm_setr_epi16(0, 0x80, 0x100, 0x180, 0, 0x80, 0x100, 0x180));
+        code = _mm_or_si128(_mm_and_si128(ascii, lanes), _mm_andnot_si128(ascii, code));
+        _mm_storeu_si128((__m128i *)(codes + 8 * half), code);
     }
-    // Null-terminate the chars array.
-    chars[size] = '\0';
+}
 
-    // Sort the characters in the chars array.
-    qsort(chars, size, sizeof(char), compare);
+/*
+ * Přičte znaky bajtů [start, end) od input, o kterých už je známo, že
+ * jsou platné UTF-8 a na end nekončí uprostřed znaku. Vektor jen z ASCII
+ * přičte do histogramu bajtů lanes, v ostatních dekóduje dvou- a
+ * tříbajtové znaky po vektorech přímo do flat, čtyřbajtové po jednom. Při
+ * nedostatku paměti vrací false.
+ */
+static bool letter_utf8_count_valid(const unsigned char *input, size_t start, size_t end, size_t len,
+                                    size_t lanes[LETTER_COUNT_LANES][256], size_t *flat,
+                                    letter_tree_node_t **rare) {
+    const __m128i lead4 = _mm_set1_epi8((char)0xF0);
+    uint16_t codes[16];
+    bool ok = true;
+    size_t p = start;
+    // The shifted loads read two bytes past the vector; they only have to stay inside the input.
+    for (; ok && p + 16 <= end && p + 18 <= len; p += 16) {
+        __m128i b0 = _mm_loadu_si128((const __m128i *)(input + p));
+        if (_mm_movemask_epi8(b0) == 0) {
+            for (int i = 0; i < 16; i += LETTER_COUNT_LANES) {
+                for (int lane = 0; lane < LETTER_COUNT_LANES; lane++) {
+                    lanes[lane][input[p + i + lane]]++;
+                }
+            }
+            continue;
+        }
+        letter_utf8_decode_vec(b0, _mm_loadu_si128((const __m128i *)(input + p + 1)),
+                               _mm_loadu_si128((const __m128i *)(input + p + 2)), codes);
+        for (int k = 0; k < 16; k++) {
+            flat[codes[k]]++;
+        }
+        uint32_t four = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(b0, lead4), b0));
+        while (ok && four != 0) {
+            size_t k = letter_count_lowest(four);
+            four &= four - 1;
+            uint32_t code;
+            letter_utf8_decode(input + p + k, len - p - k, &code);
+            ok = letter_utf8_add(flat, rare, code);
+        }
+    }
+    for (; ok && p < end; p++) {
+        if (input[p] < 0x80) {
+            lanes[0][input[p]]++;
+        } else if (input[p] >= 0xC0) {
+            uint32_t code;
+            letter_utf8_decode(input + p, len - p, &code);
+            ok = letter_utf8_add(flat, rare, code);
+        }
+    }
+    return ok;
+}
+#endif
 
-    // Create a new BST for balancing.
-    bst_node_t **new_tree = (bst_node_t **)malloc(sizeof(bst_node_t *));
-    bst_init(new_tree);
+/*
+ * Počet výskytů každého znaku (code point) textu v kódování UTF-8 o len
+ * bajtech od data.
+ *
+ * Klíčem stromu je číslo znaku, hodnotou počet výskytů. Neplatné
+ * posloupnosti se počítají jako U+FFFD a jejich počet se zapíše do
+ * *invalid (pokud není NULL). Všechny bajty se počítají jako
+ * v letter_count_bytes, pro znaky ASCII je to rovnou výsledek.
+ *
+ * Vstup se zpracovává po blocích, které končí na hranici znaku. Blok se
+ * nejdřív po vektorech ověří (SSSE3): blok jen z ASCII se počítá jako
+ * v letter_count_bytes, jiný platný blok se dekóduje po vektorech. Blok
+ * s chybou, nebo celý vstup bez SSSE3, se dekóduje po jednotlivých
+ * posloupnostech, které začínají bajtem s horním bitem.
+ * Znaky pod U+10000 se počítají v plochém poli, ostatní rovnou ve stromu.
+ * Při nedostatku paměti vrací false a prázdný strom.
+ */
+bool letter_count_utf8(letter_tree_node_t **tree, const char *data, size_t len, size_t *invalid) {
+    const unsigned char *input = (const unsigned char *)data;
+    size_t lanes[LETTER_COUNT_LANES][256] = {{0}};
+    size_t *flat = (size_t *)calloc(LETTER_COUNT_FLAT, sizeof(size_t));
+    letter_tree_node_t *rare;
+    size_t bad = 0;
+    bool ok = flat != NULL;
+    letter_tree_init(&rare);
+    letter_tree_init(tree);
+#ifdef LETTER_UTF8_DISPATCH
+    bool simd = __builtin_cpu_supports("ssse3");
+#elif defined(LETTER_UTF8_SIMD)
+    bool simd = true;
+#endif
 
-    // Insert the middle character from the sorted array into the new tree.
-    bst_insert(new_tree, chars[size / 2], value[(int)chars[size / 2]]);
+    // An ASCII byte is never part of a multi-byte sequence, valid or not. All bytes therefore go
+    // through the byte histogram and only sequences that start at a non-ASCII byte are decoded.
+    size_t next = 0;
+    for (size_t block = 0, end; ok && block < len; block = end) {
+        end = len - block < LETTER_COUNT_BLOCK ? len : block + LETTER_COUNT_BLOCK;
+        // Move the end back onto the first byte of a character, so no sequence continues past it.
+        // If the three bytes before it are continuations too, it cannot belong to an earlier byte.
+        size_t back = 0;
+        while (back < 3 && end - back < len && (input[end - back] & 0xC0) == 0x80) {
+            back++;
+        }
+        if (end - back == len || (input[end - back] & 0xC0) != 0x80) {
+            end -= back;
+        }
+#ifdef LETTER_UTF8_SIMD
+        bool ascii;
+        if (simd && letter_utf8_valid(input + block, end - block, &ascii)) {
+            if (ascii) {
+                letter_count_byte_lanes(input + block, end - block, lanes);
+            } else {
+                ok = letter_utf8_count_valid(input, block, end, len, lanes, flat, &rare);
+            }
+            next = end;
+            continue;
+        }
+#endif
+        letter_count_byte_lanes(input + block, end - block, lanes);
+        ok = letter_utf8_count_block(input, block, end, len, &next, flat, &rare, &bad);
+    }
 
-    // Balance the tree by inserting characters from the sorted array into the new tree.
-    for (int i = 0; i + (size / 2) <= size; ++i) {
-        // Insert characters to the left of the middle character.
-        if ((int)(size / 2) - i >= 0) {
-            bst_insert(new_tree, chars[size / 2 - i], value[(int)chars[size / 2 - i]]);
+    if (ok) {
+#ifdef LETTER_UTF8_SIMD
+        for (uint32_t byte = 0; byte < LETTER_COUNT_LANES * 0x80; byte++) {
+            flat[byte % 0x80] += flat[LETTER_UTF8_ASCII + byte];
+        }
+        memset(flat + LETTER_UTF8_UNUSED, 0, LETTER_UTF8_SCRATCH * sizeof(size_t));
+#endif
+        // Non-ASCII bytes were counted as code points by the decoder instead.
+        for (int lane = 0; lane < LETTER_COUNT_LANES; lane++) {
+            for (uint32_t byte = 0; byte < 0x80; byte++) {
+                flat[byte] += lanes[lane][byte];
+            }
         }
-        // Insert characters to the right of the middle character, excluding the middle character itself.
-        if (!((int)(i + size / 2) == size)) {
-            bst_insert(new_tree, chars[size / 2 + i], value[(int)chars[size / 2 + i]]);
+        ok = letter_utf8_build(tree, flat, rare);
+    }
+    free(flat);
+    letter_tree_dispose(&rare);
+    if (invalid != NULL) {
+        *invalid = bad;
+    }
+    return ok;
+}
+
+/*
+ * Narovná strom do "páteře": pravými rotacemi přesune všechny uzly do
+ * řetězce pravých potomků, seřazeného podle klíče. Vrací počet uzlů.
+ */
+static size_t bst_tree_to_vine(bst_node_t **tree) {
+    size_t count = 0;
+    bst_node_t **link = tree;
+    while (*link != NULL) {
+        bst_node_t *node = *link;
+        if (node->left != NULL) {
+            // Rotate right; the former left child is examined next.
+            bst_node_t *left = node->left;
+            node->left = left->right;
+            left->right = node;
+            *link = left;
+        } else {
+            count++;
+            link = &node->right;
         }
     }
+    return count;
+}
 
-    // Free the memory allocated for the chars array.
-    free(chars);
+/*
+ * Provede count levých rotací podél páteře, každou na každém druhém uzlu.
+ */
+static void bst_compress(bst_node_t **tree, size_t count) {
+    bst_node_t **link = tree;
+    for (size_t i = 0; i < count; i++) {
+        bst_node_t *node = *link;
+        bst_node_t *right = node->right;
+        node->right = right->left;
+        right->left = node;
+        *link = right;
+        link = &right->right;
+    }
+}
+
+/**
+ * Vyvážení stromu.
+ * 
+ * Vyvážený binární vyhledávací strom je takový binární strom, kde hloubka podstromů libovolného uzlu se od sebe liší maximálně o jedna.
+ * 
+ * Předpokládejte, že strom je alespoň inicializován. K získání uzlů stromu využijte vhodnou verzi vámi naimplmentovaného průchodu stromem.
+ * Následně můžete například vytvořit nový strom, kde pořadím vkládaných prvků zajistíte vyváženost.
+ *  
+ * Pro implementaci si můžete v tomto souboru nadefinovat vlastní pomocné funkce. Není nutné, aby funkce fungovala *in situ* (in-place).
+*/
+void bst_balance(bst_node_t **tree) {
+    // Day–Stout–Warren: straighten the tree into a sorted vine, then fold
+    // it into a complete tree. Existing nodes are relinked in place, in
+    // O(n) time with no allocation.
+    size_t count = bst_tree_to_vine(tree);
 
-    // Dispose of the original tree.
-    bst_dispose(tree);
+    // Largest perfect tree size (2^k - 1) that fits; the rest go to the bottom level.
+    size_t perfect = 0;
+    while (perfect * 2 + 1 <= count) {
+        perfect = perfect * 2 + 1;
+    }
+    bst_compress(tree, count - perfect);
+    while (perfect > 1) {
+        perfect /= 2;
+        bst_compress(tree, perfect);
+    }
+    bst_relinked(*tree);
+}
 
-    // Replace the original tree with the new balanced tree.
-    *tree = *new_tree;
+/*
+ * Postaví vyvážený podstrom z n prvků seřazených polí keys a values
+ * (uprostřed kořen, vlevo a vpravo rekurzivně zbytky). Při nedostatku
+ * paměti uvolní, co postavil, a vrátí false.
+ */
+static bool bst_build_range(bst_node_t **tree, const char *keys, const int *values, size_t n) {
+    *tree = NULL;
+    if (n == 0) {
+        return true;
+    }
+    size_t mid = n / 2;
+    bst_node_t *node = bst_node_alloc_size(bst_node_size);
+    if (node == NULL) {
+        return false;
+    }
+    node->key = keys[mid];
+    node->value = values[mid];
+    node->right = NULL;
+    if (!bst_build_range(&node->left, keys, values, mid) ||
+        !bst_build_range(&node->right, keys + mid + 1, values + mid + 1, n - mid - 1)) {
+        bst_dispose(&node->left);
+        bst_dispose(&node->right);
+        bst_node_free(node);
+        return false;
+    }
+    *tree = node;
+    return true;
+}
 
-    // Free the memory allocated for the new_tree pointer.
-    free(new_tree);
-}
\ No newline at end of file
+/*
+ * Hromadná stavba stromu z n klíčů seřazených vzestupně (bez opakování)
+ * a jejich hodnot. Strom vznikne rovnou vyvážený, v čase O(n) a bez
+ * porovnávání klíčů. Původní obsah *tree se nepoužije, strom musí být
+ * prázdný nebo zrušený. Při nedostatku paměti vrací false a *tree je
+ * prázdný strom.
+ */
+bool bst_build_from_sorted(bst_node_t **tree, const char *keys, const int *values, size_t n) {
+    if (!bst_build_range(tree, keys, values, n)) {
+        return false;
+    }
+    bst_relinked(*tree);
+    return true;
+}
@@ -9,23 +9,44 @@
  */
 
 #include "hashtable.h"
+#include "hashtable_ext.h"
+#include "stats.h"
 #include <stdlib.h>
 #include <string.h>
 
 int HT_SIZE = MAX_HT_SIZE;
 
+#ifdef IAL_STATS
+/*
+ * Délky seznamů synonym pro počítadla (stats.h), jen s IAL_STATS.
+ */
+static uint64_t ht_chain_length(ht_item_t *item) {
+    uint64_t length = 0;
+    for (; item != NULL; item = item->next) {
+        length++;
+    }
+    return length;
+}
+
+static uint64_t ht_dyn_chain_length(ht_dyn_item_t *item) {
+    uint64_t length = 0;
+    for (; item != NULL; item = item->next) {
+        length++;
+    }
+    return length;
+}
+#endif
+
 /*
  * Rozptylovací funkce která přidělí zadanému klíči index z intervalu
  * <0,HT_SIZE-1>. Ideální rozptylovací funkce by měla rozprostírat klíče
  * rovnoměrně po všech indexech. Zamyslete sa nad kvalitou zvolené funkce.
  */
 int get_hash(char *key) {
-  int result = 1;
-  int length = strlen(key);
-  for (int i = 0; i < length; i++) {
-    result += key[i];
-  }
-  return (result % HT_SIZE);
+    // One hash of the whole key; the byte sum collided on every anagram.
+    uint32_t hash = (uint32_t)(ht_hash_wy(key, strlen(key), HT_HASH_DEFAULT_SEED) >> 32);
+    // Fast range reduction: multiply and keep the high half instead of a modulo.
+    return (int)(((uint64_t)hash * (uint32_t)HT_SIZE) >> 32);
 }
 
 /*
@@ -49,12 +70,15 @@ ht_item_t *ht_search(ht_table_t *table, char *key) {
     // Retrieve the initial item from the hash table using the hash of the key.
     // 'get_hash' is assumed to be a function that converts the key into a hash value.
     ht_item_t *item = (*table)[get_hash(key)];
+    STATS_RECORD(ht_chain, ht_chain_length(item));
 
     // Loop as long as 'item' is not NULL (i.e., end of chain not reached).
     while (item) {
+        STATS_STEP();
         // Check if the current item's key matches the search key.
         if (!strcmp(key, item->key)) {
             // If the keys match, return the current item.
+            STATS_END(ht_probes);
             return item;
         }
 
@@ -64,6 +88,7 @@ ht_item_t *ht_search(ht_table_t *table, char *key) {
     }
 
     // If the key was not found in the hash table, return NULL.
+    STATS_END(ht_probes);
     return NULL;
 }
 
@@ -78,6 +103,7 @@ ht_item_t *ht_search(ht_table_t *table, char *key) {
 void ht_insert(ht_table_t *table, char *key, float value) {
     // First, try to find if the key already exists in the table.
     ht_item_t *item_find = ht_search(table, key);
+    STATS_COUNT(ht_inserts, 1);
 
     // If the key is found, update its value and return.
     if(item_find != NULL){
@@ -92,6 +118,7 @@ void ht_insert(ht_table_t *table, char *key, float value) {
     if (!new_item) {
         return;
     }
+    STATS_COUNT(ht_allocs, 1);
 
     // Initialize the new item with the provided key and value.
     new_item->key = key;
@@ -138,7 +165,9 @@ float *ht_get(ht_table_t *table, char *key) {
  */
 void ht_delete(ht_table_t *table, char *key) {
     // Retrieve the head of the list for the hashed key.
-    ht_item_t *item_find = (*table)[get_hash(key)];
+    int index = get_hash(key);
+    ht_item_t *item_find = (*table)[index];
+    STATS_COUNT(ht_deletes, 1);
 
     // Create an array to hold pointers for current and previous items.
     ht_item_t *items[3] = {[0] = NULL, [1] = NULL};
@@ -152,13 +181,16 @@ void ht_delete(ht_table_t *table, char *key) {
             // Store the next item (if deletion occurs, this will be linked to the previous item).
             items[1] = item_find ? item_find->next : NULL;
         } else {
-            // If the current item is the one to delete, free its memory.
-            free(item_find);
-            item_find = NULL;
             // Link the previous item to the next item, effectively removing the current item from the list.
+            // The head of the list has no previous item, the bucket itself must point past it.
             if (items[0]) {
                 items[0]->next = items[1];
+            } else {
+                (*table)[index] = item_find->next;
             }
+            // Then free the memory of the current item.
+            free(item_find);
+            item_find = NULL;
             break;
         }
     }
@@ -192,3 +224,578 @@ void ht_delete_all(ht_table_t *table) {
         index++;
     }
 }
+
+/*
+ * Dynamická tabulka s postupnou změnou velikosti
+ *
+ * Tabulka ht_dyn_table_t (viz hashtable_ext.h) sleduje faktor naplnění.
+ * Při jeho překročení alokuje nové pole seznamů synonym a prvky do něj
+ * přesouvá postupně — každé volání ht_dyn_insert a ht_dyn_delete přesune
+ * nejvýše HT_DYN_MIGRATE_STEP seznamů. Žádná operace tak nezaplatí celé
+ * přehashování najednou. Během přesouvání se prvky hledají v obou polích.
+ * Velikost pole je vždy mocnina dvou, index se tedy získá maskou.
+ *
+ * Funkce ht_dyn_* pro tabulky s otevřeným adresováním volají implementaci
+ * ze souboru hashtable_oa.c. Ukládání vlastních klíčů je společné.
+ */
+
+/*
+ * Úplný hash klíče podle rozptylovací funkce a semínka tabulky. Na rozdíl od
+ * get_hash není redukovaný na velikost tabulky, takže ho lze uložit do
+ * prvku a při přesunu do jiného pole jej znovu nepočítat. Do *len zapíše
+ * délku klíče.
+ */
+static uint64_t ht_dyn_hash(ht_dyn_table_t *table, const char *key, size_t *len) {
+    *len = strlen(key);
+    return table->hash(key, *len, table->seed);
+}
+
+/*
+ * Uloží klíč key délky len do prvku. S volbou own_keys klíč zkopíruje:
+ * krátký přímo do prvku, delší do areny tabulky. Při nedostatku paměti
+ * vrací false.
+ */
+bool ht_dyn_store_key(ht_dyn_table_t *table, ht_dyn_entry_t *entry, char *key, size_t len) {
+    entry->len = (uint32_t)len;
+    if (!table->own_keys) {
+        entry->key.ptr = key;
+        return true;
+    }
+    // Short keys need no allocation at all.
+    if (len <= HT_KEY_INLINE) {
+        memcpy(entry->key.inline_key, key, len + 1);
+        return true;
+    }
+    entry->key.ptr = arena_alloc(&table->keys, len + 1);
+    if (entry->key.ptr == NULL) {
+        return false;
+    }
+    STATS_COUNT(ht_allocs, 1);
+    memcpy(entry->key.ptr, key, len + 1);
+    return true;
+}
+
+/*
+ * Zaznamená smazání klíče prvku. Arena jednotlivé klíče neuvolňuje, jen se
+ * sčítá, kolik bajtů v ní leží ladem.
+ */
+void ht_dyn_drop_key(ht_dyn_table_t *table, ht_dyn_entry_t *entry) {
+    if (table->own_keys && entry->len > HT_KEY_INLINE) {
+        table->key_garbage += entry->len + 1;
+    }
+}
+
+/*
+ * Přesune dlouhé vlastní klíče všech prvků do jednoho nového bloku areny
+ * a starou arenu uvolní. Paměť smazaných klíčů se tím vrátí. Pokud se
+ * blok nepodaří alokovat, nezmění nic.
+ */
+static void ht_dyn_compact_keys(ht_dyn_table_t *table) {
+    arena_t keys;
+    arena_init(&keys);
+    // One exact-size block, so a failed allocation leaves every key where it was.
+    size_t live = table->keys.used - table->key_garbage;
+    char *copy = live ? arena_alloc(&keys, live) : NULL;
+    if (live && copy == NULL) {
+        return;
+    }
+
+    ht_dyn_item_t **arrays[2] = {table->buckets, table->old_buckets};
+    size_t starts[2] = {0, table->migrate_pos};
+    size_t sizes[2] = {table->size, table->old_size};
+
+    for (int i = 0; i < 2; i++) {
+        for (size_t index = starts[i]; index < sizes[i]; index++) {
+            ht_dyn_item_t *item = NULL;
+            ht_dyn_entry_t *entry;
+            if (table->backend == HT_BACKEND_OPEN) {
+                entry = table->ctrl[index] != HT_OA_EMPTY ? &table->slots[index] : NULL;
+            } else {
+                item = arrays[i][index];
+                entry = item ? &item->entry : NULL;
+            }
+            // Walk the chain (a single entry for open addressing).
+            while (entry != NULL) {
+                if (entry->len > HT_KEY_INLINE) {
+                    memcpy(copy, entry->key.ptr, entry->len + 1);
+                    entry->key.ptr = copy;
+                    copy += entry->len + 1;
+                }
+                item = item ? item->next : NULL;
+                entry = item ? &item->entry : NULL;
+            }
+        }
+    }
+    arena_release(&table->keys);
+    table->keys = keys;
+    table->key_garbage = 0;
+}
+
+/*
+ * Vrátí ukazatel na začátek seznamu synonym, ve kterém se nachází (nebo by
+ * se nacházel) prvek s daným hashem. Pokud seznam ve starém poli ještě
+ * nebyl přesunut, vrátí seznam ze starého pole.
+ */
+static ht_dyn_item_t **ht_dyn_old_slot(ht_dyn_table_t *table, uint64_t hash) {
+    if (table->old_buckets == NULL) {
+        return NULL;
+    }
+    size_t index = hash & (table->old_size - 1);
+    // Buckets below migrate_pos are already empty.
+    return index >= table->migrate_pos ? &table->old_buckets[index] : NULL;
+}
+
+/*
+ * Přesune nejvýše steps seznamů synonym ze starého pole do nového. Po
+ * přesunutí posledního seznamu staré pole uvolní.
+ */
+static void ht_dyn_migrate(ht_dyn_table_t *table, size_t steps) {
+    while (table->old_buckets != NULL && steps-- > 0) {
+        ht_dyn_item_t *item = table->old_buckets[table->migrate_pos];
+        // Relink every item of the chain into the new array; the cached hash spares a rehash.
+        while (item != NULL) {
+            ht_dyn_item_t *next = item->next;
+            size_t index = item->entry.hash & (table->size - 1);
+            item->next = table->buckets[index];
+            table->buckets[index] = item;
+            item = next;
+        }
+        table->old_buckets[table->migrate_pos++] = NULL;
+
+        // The whole old array has been moved, release it.
+        if (table->migrate_pos == table->old_size) {
+            free(table->old_buckets);
+            table->old_buckets = NULL;
+            table->old_size = 0;
+            table->migrate_pos = 0;
+        }
+    }
+}
+
+/*
+ * Vyhledání prvku se známým hashem v seznamech synonym. Během přesunu
+ * prohledá nové i staré pole.
+ */
+static ht_dyn_item_t *ht_chain_find(ht_dyn_table_t *table, const char *key, size_t len, uint64_t hash) {
+    // Look in the new array first, it receives every insert.
+    ht_dyn_item_t *item = table->buckets[hash & (table->size - 1)];
+    ht_dyn_item_t **old_slot = ht_dyn_old_slot(table, hash);
+    STATS_RECORD(ht_chain, ht_dyn_chain_length(item) + ht_dyn_chain_length(old_slot ? *old_slot : NULL));
+    while (item) {
+        STATS_STEP();
+        if (ht_dyn_entry_matches(table, &item->entry, key, len, hash)) {
+            STATS_END(ht_probes);
+            return item;
+        }
+        item = item->next;
+    }
+
+    // The key may still sit in a not yet migrated chain of the old array.
+    item = old_slot ? *old_slot : NULL;
+    while (item) {
+        STATS_STEP();
+        if (ht_dyn_entry_matches(table, &item->entry, key, len, hash)) {
+            STATS_END(ht_probes);
+            return item;
+        }
+        item = item->next;
+    }
+    STATS_END(ht_probes);
+    return NULL;
+}
+
+/*
+ * Zahájí změnu velikosti na new_size seznamů. Pokud ještě probíhá předchozí
+ * přesun, nejprve ho dokončí. Při neúspěšné alokaci tabulka zůstane
+ * v původní velikosti.
+ */
+static void ht_dyn_resize(ht_dyn_table_t *table, size_t new_size) {
+    ht_dyn_item_t **buckets = (ht_dyn_item_t **)calloc(new_size, sizeof(ht_dyn_item_t *));
+    if (buckets == NULL) {
+        return;
+    }
+    STATS_COUNT(ht_resizes, 1);
+    STATS_COUNT(ht_allocs, 1);
+    // Only one migration may be in flight at a time.
+    ht_dyn_migrate(table, table->old_size);
+
+    table->old_buckets = table->buckets;
+    table->old_size = table->size;
+    table->migrate_pos = 0;
+    table->buckets = buckets;
+    table->size = new_size;
+}
+
+/*
+ * Inicializace dynamické tabulky s rozptylovací funkcí a semínkem podle
+ * config (NULL znamená výchozí nastavení). Pole seznamů synonym se alokuje
+ * až při vložení prvního prvku.
+ */
+void ht_dyn_init_config(ht_dyn_table_t *table, const ht_dyn_config_t *config) {
+    table->hash = config && config->hash ? config->hash : ht_hash_wy;
+    table->seed = config ? config->seed : HT_HASH_DEFAULT_SEED;
+    table->backend = config ? config->backend : HT_BACKEND_CHAINED;
+    table->ctrl = NULL;
+    table->slots = NULL;
+    pool_init(&table->items, sizeof(ht_dyn_item_t));
+    table->own_keys = config ? config->own_keys : false;
+    arena_init(&table->keys);
+    table->key_garbage = 0;
+    table->buckets = NULL;
+    table->size = 0;
+    table->old_buckets = NULL;
+    table->old_size = 0;
+    table->migrate_pos = 0;
+    table->count = 0;
+}
+
+/*
+ * Inicializace dynamické tabulky s výchozí rozptylovací funkcí.
+ */
+void ht_dyn_init(ht_dyn_table_t *table) {
+    ht_dyn_init_config(table, NULL);
+}
+
+/*
+ * Zvětší tabulku tak, aby pojala count prvků bez další změny velikosti.
+ * Větší tabulku nezmenšuje. Při neúspěšné alokaci zůstane tabulka beze
+ * změny a poroste až při vkládání.
+ */
+void ht_dyn_reserve(ht_dyn_table_t *table, size_t count) {
+    if (table->backend == HT_BACKEND_OPEN) {
+        ht_oa_reserve(table, count);
+        return;
+    }
+    size_t size = table->size ? table->size : HT_DYN_INIT_SIZE;
+    while (size * HT_DYN_MAX_LOAD < count && size < SIZE_MAX / 2 / sizeof(ht_dyn_item_t *)) {
+        size *= 2;
+    }
+    if (size > table->size) {
+        ht_dyn_resize(table, size);
+    }
+}
+
+/*
+ * Vyhledání prvku v dynamické tabulce.
+ *
+ * V případě úspěchu vrací ukazatel na nalezený prvek; v opačném případě vrací
+ * hodnotu NULL.
+ */
+ht_dyn_entry_t *ht_dyn_search(ht_dyn_table_t *table, char *key) {
+    if (table->size == 0) {
+        return NULL;
+    }
+    size_t len;
+    uint64_t hash = ht_dyn_hash(table, key, &len);
+    if (table->backend == HT_BACKEND_OPEN) {
+        return ht_oa_search(table, key, len, hash);
+    }
+    ht_dyn_item_t *item = ht_chain_find(table, key, len, hash);
+    return item ? &item->entry : NULL;
+}
+
+/*
+ * Vložení prvku se známým hashem do seznamů synonym.
+ */
+static void ht_chain_insert(ht_dyn_table_t *table, char *key, size_t len, uint64_t hash, float value) {
+    STATS_COUNT(ht_inserts, 1);
+    // Pay off a bit of the pending migration.
+    ht_dyn_migrate(table, HT_DYN_MIGRATE_STEP);
+
+    ht_dyn_item_t *item_find = table->size ? ht_chain_find(table, key, len, hash) : NULL;
+    if (item_find != NULL) {
+        item_find->entry.value = value;
+        return;
+    }
+
+    // Grow (or allocate the first array) once the load factor is exceeded.
+    if (table->count + 1 > table->size * HT_DYN_MAX_LOAD) {
+        ht_dyn_resize(table, table->size ? table->size * 2 : HT_DYN_INIT_SIZE);
+        if (table->size == 0) {
+            return;
+        }
+    }
+
+    // Items come from the table's own pool, so they are freed all at once by ht_dyn_delete_all.
+    ht_dyn_item_t *new_item = (ht_dyn_item_t *)pool_alloc(&table->items);
+    if (!new_item) {
+        return;
+    }
+    STATS_COUNT(ht_allocs, 1);
+    if (!ht_dyn_store_key(table, &new_item->entry, key, len)) {
+        pool_free(&table->items, new_item);
+        return;
+    }
+    new_item->entry.value = value;
+    new_item->entry.hash = hash;
+
+    // Insert at the head of the chain in the new array.
+    size_t index = hash & (table->size - 1);
+    new_item->next = table->buckets[index];
+    table->buckets[index] = new_item;
+    table->count++;
+}
+
+/*
+ * Vložení nového prvku do dynamické tabulky.
+ *
+ * Pokud prvek s daným klíčem už v tabulce existuje, nahradí jeho hodnotu.
+ * Nový prvek se vkládá na začátek seznamu synonym v novém poli. Při překročení
+ * faktoru naplnění zahájí zvětšení tabulky.
+ */
+void ht_dyn_insert(ht_dyn_table_t *table, char *key, float value) {
+    size_t len;
+    uint64_t hash = ht_dyn_hash(table, key, &len);
+    if (table->backend == HT_BACKEND_OPEN) {
+        ht_oa_insert(table, key, len, hash, value);
+    } else {
+        ht_chain_insert(table, key, len, hash, value);
+    }
+}
+
+/*
+ * Získání hodnoty z dynamické tabulky.
+ *
+ * V případě úspěchu vrací funkce ukazatel na hodnotu prvku, v opačném
+ * případě hodnotu NULL.
+ */
+float *ht_dyn_get(ht_dyn_table_t *table, char *key) {
+    ht_dyn_entry_t *item_find = ht_dyn_search(table, key);
+    if (item_find != NULL) {
+        return &item_find->value;
+    }
+    return NULL;
+}
+
+/*
+ * Smazání prvku se známým hashem ze seznamů synonym.
+ */
+static void ht_chain_delete(ht_dyn_table_t *table, const char *key, size_t len, uint64_t hash) {
+    STATS_COUNT(ht_deletes, 1);
+    ht_dyn_migrate(table, table->old_size > table->size ? HT_DYN_SHRINK_STEP : HT_DYN_MIGRATE_STEP);
+
+    ht_dyn_item_t **slots[2] = {&table->buckets[hash & (table->size - 1)], ht_dyn_old_slot(table, hash)};
+
+    // Walk the chain in the new array and then the one in the old array.
+    for (int i = 0; i < 2; i++) {
+        // Pointer to the link that points at the current item.
+        ht_dyn_item_t **link = slots[i];
+        while (link != NULL && *link != NULL) {
+            ht_dyn_item_t *item = *link;
+            if (ht_dyn_entry_matches(table, &item->entry, key, len, hash)) {
+                *link = item->next;
+                ht_dyn_drop_key(table, &item->entry);
+                pool_free(&table->items, item);
+                table->count--;
+
+                // Shrink a sparse table, but never below the initial size. While a migration is in
+                // flight the shrink waits for a later delete, finishing it here would cost O(n) at once.
+                if (table->old_buckets == NULL && table->size > HT_DYN_INIT_SIZE &&
+                    table->count * HT_DYN_MIN_LOAD_DIV < table->size) {
+                    ht_dyn_resize(table, table->size / 2);
+                }
+                return;
+            }
+            link = &item->next;
+        }
+    }
+}
+
+/*
+ * Smazání prvku z dynamické tabulky.
+ *
+ * Funkce korektně uvolní všechny alokované zdroje přiřazené k danému prvku.
+ * Pokud prvek neexistuje, funkce nedělá nic. Při poklesu faktoru naplnění
+ * zahájí zmenšení tabulky.
+ */
+void ht_dyn_delete(ht_dyn_table_t *table, char *key) {
+    if (table->size == 0) {
+        return;
+    }
+    size_t len;
+    uint64_t hash = ht_dyn_hash(table, key, &len);
+    if (table->backend == HT_BACKEND_OPEN) {
+        ht_oa_delete(table, key, len, hash);
+    } else {
+        ht_chain_delete(table, key, len, hash);
+    }
+
+    // Reclaim the arena once deleted keys make up most of it.
+    if (table->key_garbage > HT_KEY_COMPACT_MIN && table->key_garbage * 2 > table->keys.used) {
+        ht_dyn_compact_keys(table);
+    }
+}
+
+/*
+ * Smazání všech prvků z dynamické tabulky.
+ *
+ * Funkce korektně uvolní všechny alokované zdroje a uvede tabulku do stavu po
+ * inicializaci.
+ */
+void ht_dyn_delete_all(ht_dyn_table_t *table) {
+    arena_release(&table->keys);
+    table->key_garbage = 0;
+    if (table->backend == HT_BACKEND_OPEN) {
+        ht_oa_delete_all(table);
+        return;
+    }
+
+    // Items live in the pool; releasing its slabs frees them all without walking the chains.
+    free(table->buckets);
+    free(table->old_buckets);
+    pool_release(&table->items);
+
+    // Keep the hash function and seed chosen at initialization.
+    table->buckets = NULL;
+    table->size = 0;
+    table->old_buckets = NULL;
+    table->old_size = 0;
+    table->migrate_pos = 0;
+    table->count = 0;
+}
+
+/*
+ * Dávkové operace
+ *
+ * Klíče se zpracovávají po skupinách HT_BATCH. Nejprve se spočítají hashe
+ * všech klíčů skupiny a přednačtou (prefetch) se jejich položky v poli,
+ * pak se přednačtou první prvky seznamů a teprve nakonec se seznamy
+ * procházejí. Výpadky cache jednotlivých klíčů se tak překrývají místo
+ * toho, aby se čekalo na každý zvlášť.
+ */
+
+#if defined(__GNUC__)
+#define HT_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define HT_PREFETCH(address) ((void)(address))
+#endif
+
+/*
+ * Spočítá hashe a délky klíčů keys[0..count-1] (count <= HT_BATCH)
+ * a přednačte domovské položky pole.
+ */
+static void ht_dyn_batch_hash(ht_dyn_table_t *table, char **keys, size_t count, uint64_t *hashes, size_t *lens) {
+    for (size_t i = 0; i < count; i++) {
+        hashes[i] = ht_dyn_hash(table, keys[i], &lens[i]);
+        if (table->size == 0) {
+            continue;
+        }
+        size_t index = hashes[i] & (table->size - 1);
+        if (table->backend == HT_BACKEND_OPEN) {
+            HT_PREFETCH(&table->ctrl[index]);
+            HT_PREFETCH(&table->slots[index]);
+        } else {
+            HT_PREFETCH(&table->buckets[index]);
+        }
+    }
+}
+
+/*
+ * Dávkové získání hodnot.
+ *
+ * Do values[i] zapíše ukazatel na hodnotu klíče keys[i], nebo NULL, pokud
+ * klíč v tabulce není. Výsledek je stejný jako count volání ht_dyn_get.
+ */
+void ht_dyn_get_many(ht_dyn_table_t *table, char **keys, size_t count, float **values) {
+    uint64_t hashes[HT_BATCH];
+    size_t lens[HT_BATCH];
+
+    for (size_t base = 0; base < count; base += HT_BATCH) {
+        size_t group = count - base < HT_BATCH ? count - base : HT_BATCH;
+        ht_dyn_batch_hash(table, keys + base, group, hashes, lens);
+
+        if (table->size == 0) {
+            for (size_t i = 0; i < group; i++) {
+                values[base + i] = NULL;
+            }
+            continue;
+        }
+        if (table->backend == HT_BACKEND_OPEN) {
+            for (size_t i = 0; i < group; i++) {
+                ht_dyn_entry_t *entry = ht_oa_search(table, keys[base + i], lens[i], hashes[i]);
+                values[base + i] = entry ? &entry->value : NULL;
+            }
+            continue;
+        }
+
+        // The bucket slots are in flight by now; prefetch the chain heads they point to.
+        for (size_t i = 0; i < group; i++) {
+            HT_PREFETCH(table->buckets[hashes[i] & (table->size - 1)]);
+        }
+        for (size_t i = 0; i < group; i++) {
+            ht_dyn_item_t *item = ht_chain_find(table, keys[base + i], lens[i], hashes[i]);
+            values[base + i] = item ? &item->entry.value : NULL;
+        }
+    }
+}
+
+/*
+ * Dávkové vložení prvků: keys[i] s hodnotou values[i]. Výsledek je stejný
+ * jako count volání ht_dyn_insert.
+ */
+void ht_dyn_insert_many(ht_dyn_table_t *table, char **keys, const float *values, size_t count) {
+    uint64_t hashes[HT_BATCH];
+    size_t lens[HT_BATCH];
+
+    for (size_t base = 0; base < count; base += HT_BATCH) {
+        size_t group = count - base < HT_BATCH ? count - base : HT_BATCH;
+        // Only the hashes are kept; inserts may resize the table between the prefetch and the use.
+        ht_dyn_batch_hash(table, keys + base, group, hashes, lens);
+
+        for (size_t i = 0; i < group; i++) {
+            if (table->backend == HT_BACKEND_OPEN) {
+                ht_oa_insert(table, keys[base + i], lens[i], hashes[i], values[base + i]);
+            } else {
+                ht_chain_insert(table, keys[base + i], lens[i], hashes[i], values[base + i]);
+            }
+        }
+    }
+}
+
+/*
+ * Histogram délek seznamů synonym.
+ *
+ * Do counts[i] zapíše počet seznamů délky i; poslední položka counts[bins-1]
+ * sčítá všechny seznamy délky alespoň bins-1. Vrací délku nejdelšího seznamu.
+ */
+size_t ht_histogram(ht_table_t *table, size_t *counts, size_t bins) {
+    size_t longest = 0;
+    memset(counts, 0, bins * sizeof(size_t));
+    for (int index = 0; index < HT_SIZE; index++) {
+        size_t length = 0;
+        for (ht_item_t *item = (*table)[index]; item != NULL; item = item->next) {
+            length++;
+        }
+        counts[length < bins ? length : bins - 1]++;
+        longest = length > longest ? length : longest;
+    }
+    return longest;
+}
+
+/*
+ * Histogram délek seznamů synonym dynamické tabulky, viz ht_histogram.
+ * Během přesunu započítá i dosud nepřesunuté seznamy starého pole. Pro
+ * otevřené adresování vrací histogram vzdáleností prvků od domovské pozice.
+ */
+size_t ht_dyn_histogram(ht_dyn_table_t *table, size_t *counts, size_t bins) {
+    if (table->backend == HT_BACKEND_OPEN) {
+        return ht_oa_histogram(table, counts, bins);
+    }
+    size_t longest = 0;
+    memset(counts, 0, bins * sizeof(size_t));
+    ht_dyn_item_t **arrays[2] = {table->buckets, table->old_buckets};
+    size_t starts[2] = {0, table->migrate_pos};
+    size_t sizes[2] = {table->size, table->old_size};
+
+    for (int i = 0; i < 2; i++) {
+        for (size_t index = starts[i]; arrays[i] != NULL && index < sizes[i]; index++) {
+            size_t length = 0;
+            for (ht_dyn_item_t *item = arrays[i][index]; item != NULL; item = item->next) {
+                length++;
+            }
+            counts[length < bins ? length : bins - 1]++;
+            longest = length > longest ? length : longest;
+        }
+    }
+    return longest;
+}
@@ -0,0 +1,321 @@
+/*
+ * Tabulka s rozptýlenými položkami — souběžná varianta
+ *
+ * Viz hashtable_conc.h. Smazaný prvek se nejprve jen odpojí ze seznamu
+ * a vlákno si ho odloží do seznamu prvků čekajících na uvolnění, označený
+ * aktuální globální epochou. Globální epocha se posune jen tehdy, když
+ * všechna právě čtoucí vlákna už aktuální epochu viděla. Prvek odložený
+ * v epoše e proto žádné vlákno nemůže číst, jakmile globální epocha
+ * dosáhne e + 2, a teprve tehdy se uvolní.
+ */
+
+#include "hashtable_conc.h"
+#include "hashtable_ext.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct ht_epoch_thread {
+    _Atomic uint64_t state;        // (epoch << 1) | 1 while reading, 0 otherwise
+    atomic_bool in_use;            // record belongs to a live thread
+    struct ht_epoch_thread *next;  // next registered record (records are never freed)
+    ht_conc_item_t *limbo[3];      // retired items by epoch % 3
+    size_t retired;                // number of items in limbo
+    uint64_t epoch;                // global epoch last seen by the owner
+} ht_epoch_thread_t;
+
+static _Atomic uint64_t ht_epoch_global = 0;
+static _Atomic(ht_epoch_thread_t *) ht_epoch_threads = NULL;
+static _Thread_local ht_epoch_thread_t *ht_epoch_self = NULL;
+
+/*
+ * Vrátí záznam volajícího vlákna, při prvním volání ho zaregistruje
+ * (přednostně převezme záznam ukončeného vlákna). Při nedostatku paměti
+ * vrací NULL.
+ */
+static ht_epoch_thread_t *ht_epoch_thread(void) {
+    if (ht_epoch_self != NULL) {
+        return ht_epoch_self;
+    }
+    // Reuse the record of a thread that called ht_conc_thread_exit.
+    for (ht_epoch_thread_t *record = atomic_load(&ht_epoch_threads); record != NULL; record = record->next) {
+        bool free_record = false;
+        if (atomic_compare_exchange_strong(&record->in_use, &free_record, true)) {
+            record->epoch = atomic_load(&ht_epoch_global);
+            return ht_epoch_self = record;
+        }
+    }
+
+    ht_epoch_thread_t *record = (ht_epoch_thread_t *)calloc(1, sizeof(ht_epoch_thread_t));
+    if (record == NULL) {
+        return NULL;
+    }
+    atomic_init(&record->state, 0);
+    atomic_init(&record->in_use, true);
+    record->epoch = atomic_load(&ht_epoch_global);
+    // Lock-free push onto the registry.
+    ht_epoch_thread_t *head = atomic_load(&ht_epoch_threads);
+    do {
+        record->next = head;
+    } while (!atomic_compare_exchange_weak(&ht_epoch_threads, &head, record));
+    return ht_epoch_self = record;
+}
+
+/*
+ * Začátek čtení: vlákno ohlásí epochu, ve které čte.
+ */
+static void ht_epoch_enter(ht_epoch_thread_t *self) {
+    uint64_t epoch = atomic_load(&ht_epoch_global);
+    atomic_store(&self->state, (epoch << 1) | 1);
+}
+
+/*
+ * Konec čtení.
+ */
+static void ht_epoch_exit(ht_epoch_thread_t *self) {
+    atomic_store_explicit(&self->state, 0, memory_order_release);
+}
+
+/*
+ * Posune globální epochu, pokud ji všechna čtoucí vlákna už viděla.
+ */
+static void ht_epoch_try_advance(void) {
+    uint64_t epoch = atomic_load(&ht_epoch_global);
+    for (ht_epoch_thread_t *record = atomic_load(&ht_epoch_threads); record != NULL; record = record->next) {
+        uint64_t state = atomic_load(&record->state);
+        if ((state & 1) && (state >> 1) != epoch) {
+            return;
+        }
+    }
+    atomic_compare_exchange_strong(&ht_epoch_global, &epoch, epoch + 1);
+}
+
+static void ht_epoch_free_list(ht_epoch_thread_t *self, int index) {
+    ht_conc_item_t *item = self->limbo[index];
+    while (item != NULL) {
+        ht_conc_item_t *next = item->retired_next;
+        free(item);
+        self->retired--;
+        item = next;
+    }
+    self->limbo[index] = NULL;
+}
+
+/*
+ * Uvolní odložené prvky, které už žádné vlákno nemůže číst.
+ */
+static void ht_epoch_collect(ht_epoch_thread_t *self) {
+    uint64_t epoch = atomic_load(&ht_epoch_global);
+    if (epoch == self->epoch) {
+        return;
+    }
+    if (epoch - self->epoch >= 2) {
+        // Everything in limbo was retired at least two epochs ago.
+        for (int i = 0; i < 3; i++) {
+            ht_epoch_free_list(self, i);
+        }
+    } else {
+        // Only the list of epoch - 2 is safe; (epoch - 2) % 3 == (epoch + 1) % 3.
+        ht_epoch_free_list(self, (int)((epoch + 1) % 3));
+    }
+    self->epoch = epoch;
+}
+
+/*
+ * Odloží odpojený prvek k pozdějšímu uvolnění.
+ */
+static void ht_epoch_retire(ht_epoch_thread_t *self, ht_conc_item_t *item) {
+    ht_epoch_collect(self);
+    int index = (int)(self->epoch % 3);
+    item->retired_next = self->limbo[index];
+    self->limbo[index] = item;
+    if (++self->retired >= HT_CONC_RETIRE_BATCH) {
+        ht_epoch_try_advance();
+        ht_epoch_collect(self);
+    }
+}
+
+/*
+ * Ukončení práce vlákna se souběžnými tabulkami. Počká, až může uvolnit
+ * všechny prvky, které vlákno smazalo, a uvolní svůj záznam pro další
+ * vlákna. Vlákno by ji mělo zavolat před svým ukončením.
+ */
+void ht_conc_thread_exit(void) {
+    ht_epoch_thread_t *self = ht_epoch_self;
+    if (self == NULL) {
+        return;
+    }
+    while (self->retired > 0) {
+        ht_epoch_try_advance();
+        ht_epoch_collect(self);
+        if (self->retired > 0) {
+            sched_yield();
+        }
+    }
+    ht_epoch_self = NULL;
+    atomic_store(&self->in_use, false);
+}
+
+/*
+ * Inicializace tabulky s počtem seznamů synonym podle očekávaného počtu
+ * prvků size_hint (zaokrouhleno na mocninu dvou). Při nedostatku paměti
+ * vrací false.
+ */
+bool ht_conc_init(ht_conc_table_t *table, size_t size_hint) {
+    size_t size = HT_CONC_STRIPES;
+    while (size < size_hint) {
+        size *= 2;
+    }
+    table->buckets = (_Atomic(ht_conc_item_t *) *)malloc(size * sizeof(*table->buckets));
+    if (table->buckets == NULL) {
+        return false;
+    }
+    for (size_t index = 0; index < size; index++) {
+        atomic_init(&table->buckets[index], NULL);
+    }
+    table->size = size;
+    table->seed = HT_HASH_DEFAULT_SEED;
+    atomic_init(&table->count, 0);
+    for (int i = 0; i < HT_CONC_STRIPES; i++) {
+        pthread_mutex_init(&table->stripes[i], NULL);
+    }
+    return true;
+}
+
+/*
+ * Získání hodnoty z tabulky bez zamykání.
+ *
+ * V případě úspěchu zapíše hodnotu prvku do *value a vrátí true, jinak vrátí
+ * false. Hodnota se kopíruje, protože prvek může jiné vlákno mezitím smazat.
+ */
+bool ht_conc_get(ht_conc_table_t *table, const char *key, float *value) {
+    ht_epoch_thread_t *self = ht_epoch_thread();
+    if (self == NULL) {
+        return false;
+    }
+    size_t len = strlen(key);
+    uint64_t hash = ht_hash_wy(key, len, table->seed);
+    bool found = false;
+
+    ht_epoch_enter(self);
+    ht_conc_item_t *item = atomic_load_explicit(&table->buckets[hash & (table->size - 1)], memory_order_acquire);
+    while (item != NULL) {
+        if (item->hash == hash && item->len == len && !memcmp(item->key, key, len)) {
+            *value = atomic_load_explicit(&item->value, memory_order_relaxed);
+            found = true;
+            break;
+        }
+        item = atomic_load_explicit(&item->next, memory_order_acquire);
+    }
+    ht_epoch_exit(self);
+    return found;
+}
+
+/*
+ * Vložení prvku do tabulky. Pokud prvek s daným klíčem už v tabulce
+ * existuje, nahradí jeho hodnotu. Klíč se do prvku kopíruje. Při nedostatku
+ * paměti vrací false.
+ */
+bool ht_conc_insert(ht_conc_table_t *table, const char *key, float value) {
+    size_t len = strlen(key);
+    uint64_t hash = ht_hash_wy(key, len, table->seed);
+    size_t index = hash & (table->size - 1);
+    pthread_mutex_t *lock = &table->stripes[index % HT_CONC_STRIPES];
+
+    pthread_mutex_lock(lock);
+    // Writers of this bucket are excluded, so plain traversal is safe here.
+    ht_conc_item_t *head = atomic_load_explicit(&table->buckets[index], memory_order_relaxed);
+    for (ht_conc_item_t *item = head; item != NULL; item = atomic_load_explicit(&item->next, memory_order_relaxed)) {
+        if (item->hash == hash && item->len == len && !memcmp(item->key, key, len)) {
+            atomic_store_explicit(&item->value, value, memory_order_relaxed);
+            pthread_mutex_unlock(lock);
+            return true;
+        }
+    }
+
+    ht_conc_item_t *new_item = (ht_conc_item_t *)malloc(sizeof(ht_conc_item_t) + len + 1);
+    if (new_item == NULL) {
+        pthread_mutex_unlock(lock);
+        return false;
+    }
+    new_item->hash = hash;
+    new_item->len = len;
+    memcpy(new_item->key, key, len + 1);
+    atomic_init(&new_item->value, value);
+    atomic_init(&new_item->next, head);
+    // Publish the fully built item; readers load the head with acquire.
+    atomic_store_explicit(&table->buckets[index], new_item, memory_order_release);
+    pthread_mutex_unlock(lock);
+
+    atomic_fetch_add_explicit(&table->count, 1, memory_order_relaxed);
+    return true;
+}
+
+/*
+ * Smazání prvku z tabulky. Prvek se odpojí ihned, uvolní se až poté, co ho
+ * žádné vlákno nemůže číst. Pokud prvek neexistuje (nebo se nepodaří
+ * zaregistrovat vlákno), funkce nedělá nic.
+ */
+void ht_conc_delete(ht_conc_table_t *table, const char *key) {
+    // Without a thread record the item could not be retired safely.
+    ht_epoch_thread_t *self = ht_epoch_thread();
+    if (self == NULL) {
+        return;
+    }
+    size_t len = strlen(key);
+    uint64_t hash = ht_hash_wy(key, len, table->seed);
+    size_t index = hash & (table->size - 1);
+    pthread_mutex_t *lock = &table->stripes[index % HT_CONC_STRIPES];
+    ht_conc_item_t *removed = NULL;
+
+    pthread_mutex_lock(lock);
+    _Atomic(ht_conc_item_t *) *link = &table->buckets[index];
+    ht_conc_item_t *item;
+    while ((item = atomic_load_explicit(link, memory_order_relaxed)) != NULL) {
+        if (item->hash == hash && item->len == len && !memcmp(item->key, key, len)) {
+            // Readers standing on the item still reach the rest of the chain through its next.
+            atomic_store_explicit(link, atomic_load_explicit(&item->next, memory_order_relaxed), memory_order_release);
+            removed = item;
+            break;
+        }
+        link = &item->next;
+    }
+    pthread_mutex_unlock(lock);
+
+    if (removed == NULL) {
+        return;
+    }
+    atomic_fetch_sub_explicit(&table->count, 1, memory_order_relaxed);
+    ht_epoch_retire(self, removed);
+}
+
+/*
+ * Smazání všech prvků z tabulky. Na rozdíl od ostatních operací se nesmí
+ * volat souběžně s jinou operací nad toutéž tabulkou.
+ */
+void ht_conc_delete_all(ht_conc_table_t *table) {
+    for (size_t index = 0; index < table->size; index++) {
+        ht_conc_item_t *item = atomic_load_explicit(&table->buckets[index], memory_order_relaxed);
+        while (item != NULL) {
+            ht_conc_item_t *next = atomic_load_explicit(&item->next, memory_order_relaxed);
+            free(item);
+            item = next;
+        }
+        atomic_store_explicit(&table->buckets[index], NULL, memory_order_relaxed);
+    }
+    atomic_store(&table->count, 0);
+}
+
+/*
+ * Zrušení tabulky: smaže všechny prvky a uvolní pole i zámky. Nesmí se
+ * volat souběžně s jinou operací nad toutéž tabulkou.
+ */
+void ht_conc_destroy(ht_conc_table_t *table) {
+    ht_conc_delete_all(table);
+    free(table->buckets);
+    table->buckets = NULL;
+    table->size = 0;
+    for (int i = 0; i < HT_CONC_STRIPES; i++) {
+        pthread_mutex_destroy(&table->stripes[i]);
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ * Tabulka s rozptýlenými položkami — souběžná varianta
+ *
+ * Tabulka ht_conc_table_t smí být používána z více vláken najednou.
+ * Zapisující operace (ht_conc_insert, ht_conc_delete) zamykají jen jeden
+ * z HT_CONC_STRIPES zámků podle indexu seznamu synonym. Čtení (ht_conc_get)
+ * nezamyká nic: ukazatele na začátky seznamů i na další prvky jsou atomické
+ * a smazané prvky se uvolňují až ve chvíli, kdy je žádné vlákno nemůže číst
+ * (epochová správa paměti, epoch-based reclamation).
+ *
+ * Počet seznamů synonym se určí při inicializaci a dále se nemění.
+ */
+
+#ifndef IAL_HASHTABLE_CONC_H
+#define IAL_HASHTABLE_CONC_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Number of writer locks; bucket i is guarded by lock i % HT_CONC_STRIPES.
+#define HT_CONC_STRIPES 64
+// Retired items a thread collects before it tries to advance the epoch.
+#define HT_CONC_RETIRE_BATCH 64
+
+typedef struct ht_conc_item {
+  _Atomic(struct ht_conc_item *) next; // ukazatel na další synonymum
+  struct ht_conc_item *retired_next;   // seznam prvků čekajících na uvolnění
+  uint64_t hash;                       // úplný hash klíče
+  size_t len;                          // délka klíče
+  _Atomic(float) value;                // hodnota
+  char key[];                          // kopie klíče
+} ht_conc_item_t;
+
+typedef struct ht_conc_table {
+  _Atomic(ht_conc_item_t *) *buckets;        // pole seznamů synonym
+  size_t size;                               // počet seznamů (mocnina dvou)
+  uint64_t seed;                             // semínko rozptylovací funkce
+  atomic_size_t count;                       // počet prvků
+  pthread_mutex_t stripes[HT_CONC_STRIPES]; // zámky zapisovatelů
+} ht_conc_table_t;
+
+bool ht_conc_init(ht_conc_table_t *table, size_t size_hint);
+bool ht_conc_get(ht_conc_table_t *table, const char *key, float *value);
+bool ht_conc_insert(ht_conc_table_t *table, const char *key, float value);
+void ht_conc_delete(ht_conc_table_t *table, const char *key);
+void ht_conc_delete_all(ht_conc_table_t *table);
+void ht_conc_destroy(ht_conc_table_t *table);
+void ht_conc_thread_exit(void);
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * Tabulka s rozptýlenými položkami — rozšíření
+ *
+ * Typ ht_table_t ze souboru hashtable.h je pole pevné velikosti MAX_HT_SIZE,
+ * a proto ho nelze za běhu zvětšit. Tento soubor deklaruje dynamickou
+ * tabulku ht_dyn_table_t se stejnými operacemi, která sleduje faktor
+ * naplnění a mění svou velikost postupně (inkrementálně).
+ *
+ * Rozptylovací funkce jsou zaměnitelné (ht_hash_fn_t) a každá tabulka má
+ * vlastní semínko (seed).
+ *
+ * Při inicializaci lze zvolit implementaci (backend): explicitně zřetězená
+ * synonyma (hashtable.c) nebo otevřené adresování s metodou Robin Hood
+ * (hashtable_oa.c), které ukládá prvky přímo v jednom poli.
+ *
+ * Každý prvek si pamatuje úplný hash a délku klíče, takže porovnání klíčů
+ * většinou skončí bez čtení jejich bajtů. S volbou own_keys si tabulka
+ * klíče kopíruje: krátké klíče uloží přímo do prvku, delší do vlastní
+ * areny, a volající nemusí své řetězce udržovat.
+ */
+
+#ifndef IAL_HASHTABLE_EXT_H
+#define IAL_HASHTABLE_EXT_H
+
+#include "hashtable.h"
+#include "pool.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Initial number of buckets of a dynamic table.
+#define HT_DYN_INIT_SIZE 8
+// The table grows once there are more items than buckets.
+#define HT_DYN_MAX_LOAD 1
+// The table shrinks once there are 8 times more buckets than items.
+#define HT_DYN_MIN_LOAD_DIV 8
+// Number of old buckets moved to the new array by one insert/delete.
+#define HT_DYN_MIGRATE_STEP 4
+// Number of old buckets moved by one delete while shrinking. The old array holds at most one
+// item per 8 buckets and must be gone before the next shrink, size / 16 deletes later.
+#define HT_DYN_SHRINK_STEP 32
+
+// Initial number of slots of an open addressing table (at least one group).
+#define HT_OA_INIT_SIZE 16
+// An open addressing table grows once it is more than 7/8 full.
+#define HT_OA_MAX_LOAD_NUM 7
+#define HT_OA_MAX_LOAD_DEN 8
+// Control bytes are probed this many at a time.
+#define HT_OA_GROUP 16
+// Control byte of an empty slot; full slots hold 7 bits of the hash.
+#define HT_OA_EMPTY 0x80
+
+// Owned keys up to this many bytes are stored inside the entry.
+#define HT_KEY_INLINE 15
+// Key arena is compacted once deleted keys take more than half of it (and at least this much).
+#define HT_KEY_COMPACT_MIN 4096
+
+// Keys hashed and prefetched together by ht_dyn_get_many/ht_dyn_insert_many.
+#define HT_BATCH 16
+
+// Default seed of tables initialized by ht_dyn_init and of get_hash.
+#define HT_HASH_DEFAULT_SEED 0x9E3779B97F4A7C15ull
+
+/*
+ * Rozptylovací funkce: vrací úplný 64bitový hash klíče délky len.
+ */
+typedef uint64_t (*ht_hash_fn_t)(const void *key, size_t len, uint64_t seed);
+
+uint64_t ht_hash_wy(const void *key, size_t len, uint64_t seed);
+uint64_t ht_hash_fnv1a(const void *key, size_t len, uint64_t seed);
+uint64_t ht_hash_additive(const void *key, size_t len, uint64_t seed);
+
+typedef enum ht_dyn_backend {
+  HT_BACKEND_CHAINED, // explicitně zřetězená synonyma
+  HT_BACKEND_OPEN,    // otevřené adresování (Robin Hood, řídicí bajty)
+} ht_dyn_backend_t;
+
+typedef struct ht_dyn_config {
+  ht_hash_fn_t hash;        // rozptylovací funkce (NULL znamená ht_hash_wy)
+  uint64_t seed;            // semínko rozptylovací funkce
+  ht_dyn_backend_t backend; // implementace tabulky
+  bool own_keys;            // tabulka si klíče kopíruje
+} ht_dyn_config_t;
+
+/*
+ * Prvek tabulky. Ukazatel vrácený z ht_dyn_search zůstává u otevřeného
+ * adresování platný jen do další změny tabulky. Klíč vrací ht_dyn_entry_key.
+ */
+typedef struct ht_dyn_entry {
+  union {
+    char *ptr;                          // klíč uložený mimo prvek
+    char inline_key[HT_KEY_INLINE + 1]; // krátký vlastní klíč (own_keys)
+  } key;
+  uint64_t hash; // úplný (neredukovaný) hash klíče
+  uint32_t len;  // délka klíče
+  float value;   // hodnota
+} ht_dyn_entry_t;
+
+typedef struct ht_dyn_item {
+  ht_dyn_entry_t entry;     // klíč, hodnota a hash
+  struct ht_dyn_item *next; // ukazatel na další synonymum
+} ht_dyn_item_t;
+
+typedef struct ht_dyn_table {
+  ht_dyn_item_t **buckets;     // aktuální pole seznamů synonym
+  size_t size;                 // počet položek pole buckets
+  ht_dyn_item_t **old_buckets; // pole, ze kterého se právě přesouvá (nebo NULL)
+  size_t old_size;             // počet položek pole old_buckets
+  size_t migrate_pos;          // první dosud nepřesunutý index v old_buckets
+  size_t count;                // počet prvků v tabulce
+  ht_hash_fn_t hash;           // rozptylovací funkce
+  uint64_t seed;               // semínko rozptylovací funkce
+  ht_dyn_backend_t backend;    // implementace tabulky
+  uint8_t *ctrl;               // řídicí bajty (HT_BACKEND_OPEN), size + HT_OA_GROUP
+  ht_dyn_entry_t *slots;       // pole prvků (HT_BACKEND_OPEN), size položek
+  pool_t items;                // paměť pro prvky ht_dyn_item_t (HT_BACKEND_CHAINED)
+  bool own_keys;               // tabulka si klíče kopíruje
+  arena_t keys;                // paměť pro vlastní klíče delší než HT_KEY_INLINE
+  size_t key_garbage;          // bajty smazaných klíčů v aréně keys
+} ht_dyn_table_t;
+
+/*
+ * Klíč prvku tabulky.
+ */
+static inline const char *ht_dyn_entry_key(const ht_dyn_table_t *table, const ht_dyn_entry_t *entry) {
+    return table->own_keys && entry->len <= HT_KEY_INLINE ? entry->key.inline_key : entry->key.ptr;
+}
+
+/*
+ * Porovná klíč prvku s klíčem key délky len a hashem hash. Bajty klíčů
+ * čte jen při shodě hashe i délky.
+ */
+static inline bool ht_dyn_entry_matches(const ht_dyn_table_t *table, const ht_dyn_entry_t *entry,
+                                        const char *key, size_t len, uint64_t hash) {
+    return entry->hash == hash && entry->len == len && !memcmp(ht_dyn_entry_key(table, entry), key, len);
+}
+
+void ht_dyn_init(ht_dyn_table_t *table);
+void ht_dyn_init_config(ht_dyn_table_t *table, const ht_dyn_config_t *config);
+ht_dyn_entry_t *ht_dyn_search(ht_dyn_table_t *table, char *key);
+void ht_dyn_insert(ht_dyn_table_t *table, char *key, float value);
+float *ht_dyn_get(ht_dyn_table_t *table, char *key);
+void ht_dyn_delete(ht_dyn_table_t *table, char *key);
+void ht_dyn_delete_all(ht_dyn_table_t *table);
+void ht_dyn_reserve(ht_dyn_table_t *table, size_t count);
+
+void ht_dyn_get_many(ht_dyn_table_t *table, char **keys, size_t count, float **values);
+void ht_dyn_insert_many(ht_dyn_table_t *table, char **keys, const float *values, size_t count);
+
+size_t ht_histogram(ht_table_t *table, size_t *counts, size_t bins);
+size_t ht_dyn_histogram(ht_dyn_table_t *table, size_t *counts, size_t bins);
+
+/*
+ * Binární obraz dynamické tabulky (hashtable_image.c). Soubor obsahuje
+ * hlavičku, začátky seznamů synonym, pole prvků (hash, klíč, hodnota)
+ * seřazené podle seznamů a za nimi klíče ukončené nulou. Funkce
+ * ht_dyn_load z něj postaví novou tabulku, ht_image_map ho jen namapuje
+ * pouze pro čtení a hledá přímo v něm, bez jediné alokace na prvek;
+ * několik procesů pak sdílí jednu kopii v page cache.
+ */
+#define HT_IMAGE_MAGIC "IALHTIMG"
+#define HT_IMAGE_VERSION 1
+
+typedef struct ht_image_header {
+  char magic[8];       // HT_IMAGE_MAGIC bez ukončující nuly
+  uint32_t version;    // HT_IMAGE_VERSION
+  uint32_t byte_order; // 0x01020304 v pořadí bajtů zapisujícího stroje
+  uint64_t seed;       // semínko rozptylovací funkce
+  uint64_t check;      // hash kontrolního klíče, ověří rozptylovací funkci
+  uint64_t count;      // počet prvků
+  uint64_t buckets;    // počet seznamů synonym, mocnina dvou
+  uint64_t keys_size;  // velikost bloku klíčů v bajtech
+} ht_image_header_t;
+
+typedef struct ht_image_entry {
+  uint64_t hash; // úplný hash klíče
+  uint64_t key;  // pozice klíče v bloku klíčů
+  uint32_t len;  // délka klíče
+  float value;   // hodnota
+} ht_image_entry_t;
+
+typedef struct ht_image {
+  void *map;                       // namapovaný soubor
+  size_t map_size;                 // velikost mapování
+  const ht_image_header_t *header; // hlavička na začátku mapování
+  const uint64_t *starts;          // začátek seznamu i je starts[i], konec starts[i + 1]
+  const ht_image_entry_t *entries; // prvky seřazené podle seznamů
+  const char *keys;                // blok klíčů
+  ht_hash_fn_t hash;               // rozptylovací funkce
+} ht_image_t;
+
+bool ht_dyn_save(ht_dyn_table_t *table, const char *path);
+bool ht_dyn_load(ht_dyn_table_t *table, const char *path, const ht_dyn_config_t *config);
+bool ht_image_map(ht_image_t *image, const char *path, ht_hash_fn_t hash);
+const float *ht_image_get(const ht_image_t *image, const char *key);
+void ht_image_unmap(ht_image_t *image);
+
+// Key storage shared by both backends (hashtable.c).
+bool ht_dyn_store_key(ht_dyn_table_t *table, ht_dyn_entry_t *entry, char *key, size_t len);
+void ht_dyn_drop_key(ht_dyn_table_t *table, ht_dyn_entry_t *entry);
+
+// Open addressing backend (hashtable_oa.c), called through the ht_dyn_* functions.
+ht_dyn_entry_t *ht_oa_search(ht_dyn_table_t *table, const char *key, size_t len, uint64_t hash);
+void ht_oa_insert(ht_dyn_table_t *table, char *key, size_t len, uint64_t hash, float value);
+void ht_oa_delete(ht_dyn_table_t *table, const char *key, size_t len, uint64_t hash);
+void ht_oa_delete_all(ht_dyn_table_t *table);
+void ht_oa_reserve(ht_dyn_table_t *table, size_t count);
+size_t ht_oa_histogram(ht_dyn_table_t *table, size_t *counts, size_t bins);
+
+#endif
@@ -0,0 +1,341 @@
+/*
+ * Tabulka s rozptýlenými položkami — binární obraz
+ *
+ * Viz hashtable_ext.h. Prvky obrazu jsou seřazené podle seznamů synonym
+ * (hash & (buckets - 1)), takže hledání v namapovaném obrazu přečte jen
+ * dvě položky pole starts a prvky jednoho seznamu. Počet seznamů je
+ * nejmenší mocnina dvou, která není menší než počet prvků.
+ *
+ * Obraz používá pořadí bajtů a zarovnání stroje, který ho zapsal; jiné
+ * pořadí bajtů a jiná verze formátu se odmítnou. Při chybě vracejí funkce
+ * false a errno popisuje příčinu (EINVAL pro poškozený nebo cizí obraz).
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "hashtable_ext.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define HT_IMAGE_BYTE_ORDER 0x01020304u
+// Hashed with the table's function and seed; a different function gives a different check.
+#define HT_IMAGE_CHECK_KEY "hashtable image check"
+
+static uint64_t ht_image_check(ht_hash_fn_t hash, uint64_t seed) {
+    return hash(HT_IMAGE_CHECK_KEY, sizeof(HT_IMAGE_CHECK_KEY) - 1, seed);
+}
+
+/*
+ * Ukazatele na všechny prvky tabulky do entries (table->count položek).
+ * Během přesunu projde i dosud nepřesunuté seznamy starého pole. Vrací
+ * počet nalezených prvků.
+ */
+static size_t ht_image_collect(ht_dyn_table_t *table, const ht_dyn_entry_t **entries) {
+    size_t count = 0;
+    if (table->backend == HT_BACKEND_OPEN) {
+        for (size_t index = 0; index < table->size && count < table->count; index++) {
+            if (table->ctrl[index] != HT_OA_EMPTY) {
+                entries[count++] = &table->slots[index];
+            }
+        }
+        return count;
+    }
+    ht_dyn_item_t **arrays[2] = {table->buckets, table->old_buckets};
+    size_t starts[2] = {0, table->migrate_pos};
+    size_t sizes[2] = {table->size, table->old_size};
+    for (int i = 0; i < 2; i++) {
+        for (size_t index = starts[i]; arrays[i] != NULL && index < sizes[i]; index++) {
+            for (ht_dyn_item_t *item = arrays[i][index]; item != NULL && count < table->count; item = item->next) {
+                entries[count++] = &item->entry;
+            }
+        }
+    }
+    return count;
+}
+
+/*
+ * Zapíše obraz do otevřeného souboru. Vrací false při chybě zápisu.
+ */
+static bool ht_image_write(FILE *file, ht_dyn_table_t *table, const ht_dyn_entry_t **sources) {
+    uint64_t count = table->count;
+    uint64_t buckets = 1;
+    while (buckets < count) {
+        buckets *= 2;
+    }
+    uint64_t *starts = (uint64_t *)calloc(buckets + 1, sizeof(uint64_t));
+    uint64_t *next = (uint64_t *)malloc(buckets * sizeof(uint64_t));
+    ht_image_entry_t *entries = (ht_image_entry_t *)malloc((count ? count : 1) * sizeof(ht_image_entry_t));
+    const ht_dyn_entry_t **order = (const ht_dyn_entry_t **)malloc((count ? count : 1) * sizeof(*order));
+    bool ok = starts != NULL && next != NULL && entries != NULL && order != NULL;
+
+    if (ok) {
+        // Counting sort by bucket: sizes, prefix sums, then placement.
+        for (uint64_t i = 0; i < count; i++) {
+            starts[(sources[i]->hash & (buckets - 1)) + 1]++;
+        }
+        for (uint64_t b = 0; b < buckets; b++) {
+            starts[b + 1] += starts[b];
+            next[b] = starts[b];
+        }
+        for (uint64_t i = 0; i < count; i++) {
+            order[next[sources[i]->hash & (buckets - 1)]++] = sources[i];
+        }
+        // Keys follow in the same order as the entries.
+        uint64_t keys_size = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            entries[i] = (ht_image_entry_t){order[i]->hash, keys_size, order[i]->len, order[i]->value};
+            keys_size += order[i]->len + 1;
+        }
+
+        ht_image_header_t header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, HT_IMAGE_MAGIC, sizeof(header.magic));
+        header.version = HT_IMAGE_VERSION;
+        header.byte_order = HT_IMAGE_BYTE_ORDER;
+        header.seed = table->seed;
+        header.check = ht_image_check(table->hash, table->seed);
+        header.count = count;
+        header.buckets = buckets;
+        header.keys_size = keys_size;
+        ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(starts, sizeof(uint64_t), buckets + 1, file) == buckets + 1 &&
+             fwrite(entries, sizeof(ht_image_entry_t), count, file) == count;
+        for (uint64_t i = 0; ok && i < count; i++) {
+            // Every key is written with its terminating zero, so lookups can use the blob in place.
+            ok = fwrite(ht_dyn_entry_key(table, order[i]), 1, order[i]->len, file) == order[i]->len &&
+                 fputc('\0', file) != EOF;
+        }
+    } else {
+        errno = ENOMEM;
+    }
+    int saved = errno;
+    free(starts);
+    free(next);
+    free(entries);
+    free(order);
+    errno = saved;
+    return ok;
+}
+
+/*
+ * Uloží tabulku jako obraz do souboru path. Zapisuje do path.tmp, který
+ * po úspěšném zápisu přejmenuje, takže soubor path vždy obsahuje celý
+ * starý nebo celý nový obraz.
+ */
+bool ht_dyn_save(ht_dyn_table_t *table, const char *path) {
+    const ht_dyn_entry_t **sources = (const ht_dyn_entry_t **)malloc((table->count ? table->count : 1) *
+                                                                     sizeof(*sources));
+    size_t tmp_size = strlen(path) + sizeof(".tmp");
+    char *tmp = (char *)malloc(tmp_size);
+    if (sources == NULL || tmp == NULL) {
+        free(sources);
+        free(tmp);
+        errno = ENOMEM;
+        return false;
+    }
+    snprintf(tmp, tmp_size, "%s.tmp", path);
+
+    bool ok = ht_image_collect(table, sources) == table->count;
+    if (!ok) {
+        errno = EINVAL;
+    }
+    FILE *file = ok ? fopen(tmp, "wb") : NULL;
+    ok = file != NULL && ht_image_write(file, table, sources);
+    // The data must be on disk before the rename makes it visible.
+    ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (file != NULL) {
+        ok = fclose(file) == 0 && ok;
+    }
+    ok = ok && rename(tmp, path) == 0;
+
+    int saved = errno;
+    if (!ok && file != NULL) {
+        remove(tmp);
+    }
+    free(sources);
+    free(tmp);
+    errno = saved;
+    return ok;
+}
+
+/*
+ * Namapuje soubor path a zkontroluje hlavičku a velikosti polí. Obsah
+ * polí kontroluje až hledání, aby namapování nemuselo číst celý soubor.
+ */
+static bool ht_image_open(ht_image_t *image, const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return false;
+    }
+    if ((uint64_t)st.st_size < sizeof(ht_image_header_t) || (uint64_t)st.st_size > SIZE_MAX) {
+        close(fd);
+        errno = EINVAL;
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    int saved = errno;
+    // The mapping keeps the file alive on its own.
+    close(fd);
+    if (map == MAP_FAILED) {
+        errno = saved;
+        return false;
+    }
+
+    const ht_image_header_t *header = (const ht_image_header_t *)map;
+    uint64_t rest = size - sizeof(ht_image_header_t);
+    bool ok = !memcmp(header->magic, HT_IMAGE_MAGIC, sizeof(header->magic)) &&
+              header->version == HT_IMAGE_VERSION && header->byte_order == HT_IMAGE_BYTE_ORDER &&
+              header->buckets != 0 && (header->buckets & (header->buckets - 1)) == 0 &&
+              // Each array must fit into what is left, checked without overflowing.
+              header->buckets < rest / sizeof(uint64_t) &&
+              header->count <= (rest - (header->buckets + 1) * sizeof(uint64_t)) / sizeof(ht_image_entry_t) &&
+              header->keys_size == rest - (header->buckets + 1) * sizeof(uint64_t) -
+                                       header->count * sizeof(ht_image_entry_t);
+    if (!ok) {
+        munmap(map, size);
+        errno = EINVAL;
+        return false;
+    }
+    image->map = map;
+    image->map_size = size;
+    image->header = header;
+    image->starts = (const uint64_t *)(header + 1);
+    image->entries = (const ht_image_entry_t *)(image->starts + header->buckets + 1);
+    image->keys = (const char *)(image->entries + header->count);
+    image->hash = NULL;
+    return true;
+}
+
+/*
+ * Klíč prvku entry obrazu, nebo NULL, pokud ukazuje mimo blok klíčů.
+ */
+static const char *ht_image_key(const ht_image_t *image, const ht_image_entry_t *entry) {
+    uint64_t keys_size = image->header->keys_size;
+    if (entry->key >= keys_size || entry->len >= keys_size - entry->key ||
+        image->keys[entry->key + entry->len] != '\0') {
+        return NULL;
+    }
+    return image->keys + entry->key;
+}
+
+/*
+ * Načtení obrazu ze souboru path do nové tabulky s nastavením config
+ * (NULL znamená výchozí nastavení). Tabulka si klíče vždy kopíruje, soubor
+ * po načtení není potřeba. Při chybě zůstane tabulka prázdná.
+ */
+bool ht_dyn_load(ht_dyn_table_t *table, const char *path, const ht_dyn_config_t *config) {
+    ht_dyn_config_t own = {NULL, HT_HASH_DEFAULT_SEED, HT_BACKEND_CHAINED, true};
+    if (config != NULL) {
+        own = *config;
+        own.own_keys = true;
+    }
+    ht_dyn_init_config(table, &own);
+
+    ht_image_t image;
+    if (!ht_image_open(&image, path)) {
+        return false;
+    }
+    // Entries come in bucket order, grouped by home position. A growing open addressing table
+    // would gather such a stream into runs that every further insert walks; one of its final
+    // size takes it as a sequential fill.
+    ht_dyn_reserve(table, image.header->count);
+    // The keys are hashed again, so the table may use a different hash function than the image.
+    bool ok = true;
+    for (uint64_t i = 0; ok && i < image.header->count; i++) {
+        const char *key = ht_image_key(&image, &image.entries[i]);
+        ok = key != NULL && strlen(key) == image.entries[i].len;
+        if (!ok) {
+            errno = EINVAL;
+            break;
+        }
+        size_t before = table->count;
+        ht_dyn_insert(table, (char *)key, image.entries[i].value);
+        // Keys of an image are distinct, an insert that adds nothing ran out of memory.
+        ok = table->count == before + 1;
+        if (!ok) {
+            errno = ENOMEM;
+        }
+    }
+    int saved = errno;
+    ht_image_unmap(&image);
+    if (!ok) {
+        ht_dyn_delete_all(table);
+    }
+    errno = saved;
+    return ok;
+}
+
+/*
+ * Namapuje obraz ze souboru path pouze pro čtení. Funkce hash (NULL
+ * znamená ht_hash_wy) musí být ta, se kterou byl obraz uložen; jinak
+ * vrací false s errno EINVAL. Nic dalšího nealokuje.
+ */
+bool ht_image_map(ht_image_t *image, const char *path, ht_hash_fn_t hash) {
+    if (!ht_image_open(image, path)) {
+        return false;
+    }
+    image->hash = hash != NULL ? hash : ht_hash_wy;
+    if (ht_image_check(image->hash, image->header->seed) != image->header->check) {
+        ht_image_unmap(image);
+        errno = EINVAL;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Vyhledání v namapovaném obrazu.
+ *
+ * V případě úspěchu vrací ukazatel na hodnotu prvku (v mapování, jen pro
+ * čtení), v opačném případě hodnotu NULL. Prvek s poškozenými údaji se
+ * nikdy nenajde.
+ */
+const float *ht_image_get(const ht_image_t *image, const char *key) {
+    const ht_image_header_t *header = image->header;
+    size_t len = strlen(key);
+    uint64_t hash = image->hash(key, len, header->seed);
+    uint64_t bucket = hash & (header->buckets - 1);
+    uint64_t begin = image->starts[bucket];
+    uint64_t end = image->starts[bucket + 1];
+    if (begin > end || end > header->count) {
+        return NULL;
+    }
+    for (uint64_t i = begin; i < end; i++) {
+        const ht_image_entry_t *entry = &image->entries[i];
+        if (entry->hash != hash || entry->len != len) {
+            continue;
+        }
+        const char *stored = ht_image_key(image, entry);
+        if (stored != NULL && !memcmp(stored, key, len)) {
+            return &entry->value;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Zruší mapování obrazu. Ukazatele vrácené z ht_image_get tím přestanou
+ * platit.
+ */
+void ht_image_unmap(ht_image_t *image) {
+    if (image->map != NULL) {
+        munmap(image->map, image->map_size);
+    }
+    image->map = NULL;
+    image->map_size = 0;
+    image->header = NULL;
+}
@@ -0,0 +1,296 @@
+/*
+ * Tabulka s rozptýlenými položkami — otevřené adresování
+ *
+ * Prvky jsou uloženy přímo v poli slots, bez alokace pro každý prvek.
+ * Ke každé pozici patří řídicí bajt: HT_OA_EMPTY pro volnou pozici, jinak
+ * horních 7 bitů hashe. Vyhledávání porovnává řídicí bajty po skupinách
+ * (16 najednou s SSE2, jinak 8 najednou jako SWAR v 64bitovém slově)
+ * a klíče porovnává jen u shodných bajtů. Prvky se při přesunech kopírují
+ * celé, krátké vlastní klíče uložené v prvku se tedy přesouvají s nimi.
+ *
+ * Vkládání používá metodu Robin Hood (prvek blíže své domovské pozici
+ * uvolní místo vzdálenějšímu) a mazání posouvá následující prvky zpět,
+ * takže tabulka nepotřebuje náhrobky (tombstones). Změna velikosti
+ * přehashuje celé pole najednou.
+ */
+
+#include "hashtable_ext.h"
+#include "stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Build with -DHT_OA_NO_SIMD to force the portable SWAR probe.
+#if (defined(__SSE2__) || defined(_M_X64)) && !defined(HT_OA_NO_SIMD)
+#include <emmintrin.h>
+#define HT_OA_SSE2 1
+// Control bytes compared by one probe step and bits per control byte in a match mask.
+#define HT_OA_WIDTH 16
+#define HT_OA_MASK_SHIFT 0
+typedef uint32_t ht_oa_bits_t;
+#else
+#define HT_OA_WIDTH 8
+#define HT_OA_MASK_SHIFT 3
+typedef uint64_t ht_oa_bits_t;
+#endif
+
+#define HT_OA_LSB 0x0101010101010101ull
+#define HT_OA_MSB 0x8080808080808080ull
+
+static inline uint8_t ht_oa_h2(uint64_t hash) {
+    // The low bits pick the home slot, so take the fragment from the top.
+    return (uint8_t)(hash >> 57);
+}
+
+/*
+ * Vrátí masku pozic ve skupině řídicích bajtů od ctrl, které jsou rovné h2.
+ * Do *empty zapíše masku volných pozic.
+ */
+static inline ht_oa_bits_t ht_oa_match(const uint8_t *ctrl, uint8_t h2, ht_oa_bits_t *empty) {
+#ifdef HT_OA_SSE2
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    *empty = (ht_oa_bits_t)_mm_movemask_epi8(group);
+    return (ht_oa_bits_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2)));
+#else
+    uint64_t group;
+    memcpy(&group, ctrl, sizeof(group));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    group = __builtin_bswap64(group);
+#endif
+    *empty = group & HT_OA_MSB;
+    // Zero bytes of x are the matches; a false positive right above a true match is
+    // harmless because candidates are confirmed against the full hash.
+    uint64_t x = group ^ (HT_OA_LSB * h2);
+    return (x - HT_OA_LSB) & ~x & HT_OA_MSB;
+#endif
+}
+
+static inline size_t ht_oa_lowest(ht_oa_bits_t bits) {
+#ifdef HT_OA_SSE2
+    return (size_t)__builtin_ctz(bits);
+#else
+    return (size_t)__builtin_ctzll(bits) >> HT_OA_MASK_SHIFT;
+#endif
+}
+
+/*
+ * Nastaví řídicí bajt pozice index. První skupina je zrcadlena za konec
+ * pole, aby čtení skupiny nemuselo řešit přetečení indexu.
+ */
+static inline void ht_oa_set_ctrl(ht_dyn_table_t *table, size_t index, uint8_t value) {
+    table->ctrl[index] = value;
+    if (index < HT_OA_GROUP) {
+        table->ctrl[table->size + index] = value;
+    }
+}
+
+/*
+ * Vzdálenost prvku na pozici index od jeho domovské pozice.
+ */
+static inline size_t ht_oa_dist(ht_dyn_table_t *table, size_t index) {
+    size_t mask = table->size - 1;
+    return (index - (table->slots[index].hash & mask)) & mask;
+}
+
+/*
+ * Uloží prvek na pozici podle metody Robin Hood. Předpokládá, že klíč
+ * v tabulce není a že v ní je volná pozice.
+ */
+static void ht_oa_place(ht_dyn_table_t *table, ht_dyn_entry_t entry) {
+    size_t mask = table->size - 1;
+    size_t pos = entry.hash & mask;
+    size_t dist = 0;
+
+    while (table->ctrl[pos] != HT_OA_EMPTY) {
+        size_t existing = ht_oa_dist(table, pos);
+        // Rob the rich: a resident closer to home yields its slot and moves on instead.
+        if (existing < dist) {
+            ht_dyn_entry_t tmp = table->slots[pos];
+            table->slots[pos] = entry;
+            ht_oa_set_ctrl(table, pos, ht_oa_h2(entry.hash));
+            entry = tmp;
+            dist = existing;
+        }
+        pos = (pos + 1) & mask;
+        dist++;
+    }
+    table->slots[pos] = entry;
+    ht_oa_set_ctrl(table, pos, ht_oa_h2(entry.hash));
+}
+
+/*
+ * Přealokuje pole na new_size pozic a vloží do nich všechny prvky. Při
+ * neúspěšné alokaci tabulka zůstane v původní velikosti.
+ */
+static void ht_oa_resize(ht_dyn_table_t *table, size_t new_size) {
+    uint8_t *ctrl = (uint8_t *)malloc(new_size + HT_OA_GROUP);
+    ht_dyn_entry_t *slots = (ht_dyn_entry_t *)malloc(new_size * sizeof(ht_dyn_entry_t));
+    if (ctrl == NULL || slots == NULL) {
+        free(ctrl);
+        free(slots);
+        return;
+    }
+    memset(ctrl, HT_OA_EMPTY, new_size + HT_OA_GROUP);
+    STATS_COUNT(ht_resizes, 1);
+    STATS_COUNT(ht_allocs, 2);
+
+    uint8_t *old_ctrl = table->ctrl;
+    ht_dyn_entry_t *old_slots = table->slots;
+    size_t old_size = table->size;
+    table->ctrl = ctrl;
+    table->slots = slots;
+    table->size = new_size;
+
+    for (size_t index = 0; index < old_size; index++) {
+        if (old_ctrl[index] != HT_OA_EMPTY) {
+            ht_oa_place(table, old_slots[index]);
+        }
+    }
+    free(old_ctrl);
+    free(old_slots);
+}
+
+/*
+ * Vyhledání prvku se známým hashem.
+ *
+ * V případě úspěchu vrací ukazatel na nalezený prvek; v opačném případě vrací
+ * hodnotu NULL.
+ */
+ht_dyn_entry_t *ht_oa_search(ht_dyn_table_t *table, const char *key, size_t len, uint64_t hash) {
+    if (table->size == 0) {
+        return NULL;
+    }
+    size_t mask = table->size - 1;
+    size_t pos = hash & mask;
+    uint8_t h2 = ht_oa_h2(hash);
+
+    for (size_t probed = 0; probed < table->size; probed += HT_OA_WIDTH) {
+        ht_oa_bits_t empty;
+        ht_oa_bits_t match = ht_oa_match(table->ctrl + pos, h2, &empty);
+        while (match) {
+            size_t index = (pos + ht_oa_lowest(match)) & mask;
+            STATS_STEP();
+            if (ht_dyn_entry_matches(table, &table->slots[index], key, len, hash)) {
+                STATS_END(ht_probes);
+                return &table->slots[index];
+            }
+            match &= match - 1;
+        }
+        // Runs are contiguous, so the key cannot lie past an empty slot.
+        if (empty) {
+            STATS_END(ht_probes);
+            return NULL;
+        }
+        pos = (pos + HT_OA_WIDTH) & mask;
+    }
+    STATS_END(ht_probes);
+    return NULL;
+}
+
+/*
+ * Vložení prvku se známým hashem. Pokud prvek s daným klíčem už v tabulce
+ * existuje, nahradí jeho hodnotu.
+ */
+void ht_oa_insert(ht_dyn_table_t *table, char *key, size_t len, uint64_t hash, float value) {
+    STATS_COUNT(ht_inserts, 1);
+    ht_dyn_entry_t *entry = ht_oa_search(table, key, len, hash);
+    if (entry != NULL) {
+        entry->value = value;
+        return;
+    }
+
+    // Keep the load factor below 7/8 so probe runs stay short.
+    if ((table->count + 1) * HT_OA_MAX_LOAD_DEN > table->size * HT_OA_MAX_LOAD_NUM) {
+        ht_oa_resize(table, table->size ? table->size * 2 : HT_OA_INIT_SIZE);
+    }
+    // A failed resize still leaves room until the array is completely full.
+    if (table->count == table->size) {
+        return;
+    }
+
+    ht_dyn_entry_t new_entry = {.value = value, .hash = hash};
+    if (!ht_dyn_store_key(table, &new_entry, key, len)) {
+        return;
+    }
+    ht_oa_place(table, new_entry);
+    table->count++;
+}
+
+/*
+ * Smazání prvku se známým hashem. Následující prvky téhož běhu se posunou
+ * o jednu pozici zpět, dokud nenarazí na volnou pozici nebo na prvek ve své
+ * domovské pozici.
+ */
+void ht_oa_delete(ht_dyn_table_t *table, const char *key, size_t len, uint64_t hash) {
+    STATS_COUNT(ht_deletes, 1);
+    ht_dyn_entry_t *entry = ht_oa_search(table, key, len, hash);
+    if (entry == NULL) {
+        return;
+    }
+    ht_dyn_drop_key(table, entry);
+    size_t mask = table->size - 1;
+    size_t index = (size_t)(entry - table->slots);
+
+    // Backward shift instead of leaving a tombstone.
+    for (;;) {
+        size_t next = (index + 1) & mask;
+        if (table->ctrl[next] == HT_OA_EMPTY || ht_oa_dist(table, next) == 0) {
+            break;
+        }
+        table->slots[index] = table->slots[next];
+        ht_oa_set_ctrl(table, index, table->ctrl[next]);
+        index = next;
+    }
+    ht_oa_set_ctrl(table, index, HT_OA_EMPTY);
+    table->count--;
+
+    // Shrink a sparse table, but never below the initial size.
+    if (table->size > HT_OA_INIT_SIZE && table->count * HT_DYN_MIN_LOAD_DIV < table->size) {
+        ht_oa_resize(table, table->size / 2);
+    }
+}
+
+/*
+ * Zvětší pole tak, aby pojalo count prvků bez další změny velikosti.
+ */
+void ht_oa_reserve(ht_dyn_table_t *table, size_t count) {
+    size_t size = table->size ? table->size : HT_OA_INIT_SIZE;
+    // Sizes are powers of two of at least HT_OA_INIT_SIZE, so the division is exact and cannot overflow.
+    while (size / HT_OA_MAX_LOAD_DEN * HT_OA_MAX_LOAD_NUM < count && size < SIZE_MAX / 2 / sizeof(ht_dyn_entry_t)) {
+        size *= 2;
+    }
+    if (size > table->size) {
+        ht_oa_resize(table, size);
+    }
+}
+
+/*
+ * Smazání všech prvků. Uvolní obě pole a uvede tabulku do stavu po
+ * inicializaci.
+ */
+void ht_oa_delete_all(ht_dyn_table_t *table) {
+    free(table->ctrl);
+    free(table->slots);
+    table->ctrl = NULL;
+    table->slots = NULL;
+    table->size = 0;
+    table->count = 0;
+}
+
+/*
+ * Histogram vzdáleností prvků od jejich domovské pozice: do counts[i]
+ * zapíše počet prvků ve vzdálenosti i, poslední položka sčítá všechny
+ * vzdálenější. Vrací největší vzdálenost.
+ */
+size_t ht_oa_histogram(ht_dyn_table_t *table, size_t *counts, size_t bins) {
+    size_t longest = 0;
+    memset(counts, 0, bins * sizeof(size_t));
+    for (size_t index = 0; index < table->size; index++) {
+        if (table->ctrl[index] == HT_OA_EMPTY) {
+            continue;
+        }
+        size_t dist = ht_oa_dist(table, index);
+        counts[dist < bins ? dist : bins - 1]++;
+        longest = dist > longest ? dist : longest;
+    }
+    return longest;
+}
@@ -0,0 +1,218 @@
+/*
+ * Rozptylovací funkce pro tabulky s rozptýlenými položkami
+ *
+ * Všechny funkce mají rozhraní ht_hash_fn_t (viz hashtable_ext.h): vrací
+ * úplný 64bitový hash klíče délky len pro zadané semínko (seed). Redukci
+ * na index do pole provádí až tabulka.
+ */
+
+#include "hashtable_ext.h"
+#include <string.h>
+
+// Build with -DHT_HASH_NO_SIMD to force the scalar path.
+#if (defined(__SSE2__) || defined(_M_X64)) && !defined(HT_HASH_NO_SIMD)
+#include <emmintrin.h>
+#define HT_HASH_SSE2 1
+#endif
+
+// Keys at least this long take the striped (vectorizable) path.
+#define HT_HASH_LONG_KEY 256
+// One stripe is 8 lanes of 8 bytes.
+#define HT_HASH_STRIPE 64
+// Accumulators are scrambled after this many stripes.
+#define HT_HASH_STRIPES_PER_BLOCK 16
+
+static const uint64_t ht_hash_primes[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+    0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull,
+};
+
+/*
+ * 64×64 bitové násobení, jehož 128bitový výsledek se složí operací xor.
+ */
+static inline uint64_t ht_hash_mix(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    // Schoolbook multiplication on 32-bit halves.
+    uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t lo = t + (rm1 << 32);
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+    return lo ^ hi;
+#endif
+}
+
+static inline uint64_t ht_hash_read8(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t ht_hash_read4(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/*
+ * Dlouhé klíče: 8 nezávislých akumulátorů po 8 bajtech (pruh 64 bajtů),
+ * které lze zpracovat vektorově. Skalární i SSE2 varianta počítají stejný
+ * výsledek.
+ */
+#ifndef HT_HASH_SSE2
+static void ht_hash_stripes_scalar(uint64_t acc[8], const uint64_t secret[8], const unsigned char *p, size_t stripes) {
+    for (size_t s = 0; s < stripes; s++, p += HT_HASH_STRIPE) {
+        for (int i = 0; i < 8; i++) {
+            uint64_t data = ht_hash_read8(p + 8 * i);
+            uint64_t key = data ^ secret[i];
+            // Neighbouring lane gets the raw data so no input bit is lost to the product.
+            acc[i ^ 1] += data;
+            acc[i] += (key & 0xffffffffu) * (key >> 32);
+        }
+        if ((s + 1) % HT_HASH_STRIPES_PER_BLOCK == 0) {
+            for (int i = 0; i < 8; i++) {
+                acc[i] = ((acc[i] ^ (acc[i] >> 47)) ^ secret[i]) * 0x9E3779B1u;
+            }
+        }
+    }
+}
+#else
+static void ht_hash_stripes_sse2(uint64_t acc[8], const uint64_t secret[8], const unsigned char *p, size_t stripes) {
+    __m128i vacc[4], vsecret[4];
+    for (int i = 0; i < 4; i++) {
+        vacc[i] = _mm_loadu_si128((const __m128i *)(acc + 2 * i));
+        vsecret[i] = _mm_loadu_si128((const __m128i *)(secret + 2 * i));
+    }
+    const __m128i prime = _mm_set1_epi32((int)0x9E3779B1u);
+
+    for (size_t s = 0; s < stripes; s++, p += HT_HASH_STRIPE) {
+        for (int i = 0; i < 4; i++) {
+            __m128i data = _mm_loadu_si128((const __m128i *)(p + 16 * i));
+            __m128i key = _mm_xor_si128(data, vsecret[i]);
+            // lo32(key) * hi32(key) for both 64-bit lanes.
+            __m128i product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+            // Swapping the 64-bit lanes gives acc[i ^ 1] += data.
+            __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            vacc[i] = _mm_add_epi64(vacc[i], _mm_add_epi64(product, swapped));
+        }
+        if ((s + 1) % HT_HASH_STRIPES_PER_BLOCK == 0) {
+            for (int i = 0; i < 4; i++) {
+                __m128i a = _mm_xor_si128(vacc[i], _mm_srli_epi64(vacc[i], 47));
+                a = _mm_xor_si128(a, vsecret[i]);
+                // 64x32 multiply assembled from two 32x32 products.
+                __m128i lo = _mm_mul_epu32(a, prime);
+                __m128i hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+                vacc[i] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+            }
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        _mm_storeu_si128((__m128i *)(acc + 2 * i), vacc[i]);
+    }
+}
+#endif
+
+static uint64_t ht_hash_long(const unsigned char *p, size_t len, uint64_t seed) {
+    uint64_t acc[8], secret[8];
+    for (int i = 0; i < 8; i++) {
+        secret[i] = ht_hash_mix(seed ^ ht_hash_primes[i & 3], ht_hash_primes[(i + 1) & 3] + (uint64_t)i);
+        acc[i] = ht_hash_primes[i & 3];
+    }
+
+    size_t stripes = len / HT_HASH_STRIPE;
+#ifdef HT_HASH_SSE2
+    ht_hash_stripes_sse2(acc, secret, p, stripes);
+#else
+    ht_hash_stripes_scalar(acc, secret, p, stripes);
+#endif
+
+    // Fold the accumulators, then hash the tail with the short-key function.
+    uint64_t result = len * ht_hash_primes[0];
+    for (int i = 0; i < 8; i += 2) {
+        result ^= ht_hash_mix(acc[i] ^ secret[i], acc[i + 1] ^ secret[i + 1]);
+    }
+    size_t done = stripes * HT_HASH_STRIPE;
+    return ht_hash_mix(result, ht_hash_wy(p + done, len - done, seed) ^ ht_hash_primes[1]);
+}
+
+/*
+ * Rychlá rozptylovací funkce ve stylu wyhash. Klíč čte po 8 bajtech,
+ * klíče od HT_HASH_LONG_KEY bajtů zpracovává po 64bajtových pruzích
+ * (s SSE2, je-li k dispozici).
+ */
+uint64_t ht_hash_wy(const void *key, size_t len, uint64_t seed) {
+    const unsigned char *p = (const unsigned char *)key;
+    if (len >= HT_HASH_LONG_KEY) {
+        return ht_hash_long(p, len, seed);
+    }
+
+    uint64_t a, b;
+    seed ^= ht_hash_mix(seed ^ ht_hash_primes[0], ht_hash_primes[1]);
+    if (len <= 16) {
+        if (len >= 4) {
+            // Two possibly overlapping 4-byte reads from each end cover 4..16 bytes.
+            size_t shift = (len >> 3) << 2;
+            a = (ht_hash_read4(p) << 32) | ht_hash_read4(p + shift);
+            b = (ht_hash_read4(p + len - 4) << 32) | ht_hash_read4(p + len - 4 - shift);
+        } else if (len > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            // Three independent chains keep the multiplier busy.
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = ht_hash_mix(ht_hash_read8(p) ^ ht_hash_primes[1], ht_hash_read8(p + 8) ^ seed);
+                see1 = ht_hash_mix(ht_hash_read8(p + 16) ^ ht_hash_primes[2], ht_hash_read8(p + 24) ^ see1);
+                see2 = ht_hash_mix(ht_hash_read8(p + 32) ^ ht_hash_primes[3], ht_hash_read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = ht_hash_mix(ht_hash_read8(p) ^ ht_hash_primes[1], ht_hash_read8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        // The last 16 bytes, overlapping already hashed ones if needed.
+        a = ht_hash_read8(p + i - 16);
+        b = ht_hash_read8(p + i - 8);
+    }
+    a ^= ht_hash_primes[1];
+    b ^= seed;
+    return ht_hash_mix(ht_hash_mix(a, b) ^ ht_hash_primes[0] ^ len, b ^ ht_hash_primes[1]);
+}
+
+/*
+ * FNV-1a, jednoduchá rozptylovací funkce po bajtech. Slouží pro srovnání.
+ */
+uint64_t ht_hash_fnv1a(const void *key, size_t len, uint64_t seed) {
+    const unsigned char *p = (const unsigned char *)key;
+    uint64_t hash = 14695981039346656037ull ^ seed;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/*
+ * Původní součtová rozptylovací funkce z get_hash. Slouží pro srovnání —
+ * všechny přesmyčky (anagramy) mají stejný hash.
+ */
+uint64_t ht_hash_additive(const void *key, size_t len, uint64_t seed) {
+    const unsigned char *p = (const unsigned char *)key;
+    uint64_t hash = 1 + seed;
+    for (size_t i = 0; i < len; i++) {
+        hash += p[i];
+    }
+    return hash;
+}
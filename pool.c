@@ -0,0 +1,121 @@
+/*
+ * Alokátor paměti pro uzly pevné velikosti
+ *
+ * Viz pool.h. Bloky poolu i areny se alokují funkcí malloc, každý další
+ * dvakrát větší než předchozí (nejvýše POOL_SLAB_MAX), takže i tabulka
+ * s miliony prvků potřebuje jen desítky bloků.
+ */
+
+#include "pool.h"
+#include <stdlib.h>
+
+/*
+ * Inicializace poolu pro objekty velikosti obj_size. Paměť se alokuje až
+ * při prvním požadavku.
+ */
+void pool_init(pool_t *pool, size_t obj_size) {
+    // Every object must be able to hold the free list link.
+    if (obj_size < sizeof(void *)) {
+        obj_size = sizeof(void *);
+    }
+    pool->obj_size = (obj_size + 7) & ~(size_t)7;
+    pool->slab_size = POOL_SLAB_MIN;
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->bump = NULL;
+    pool->bump_end = NULL;
+}
+
+/*
+ * Alokuje další blok. Vrací false, pokud se alokace nepodařila.
+ */
+bool pool_grow(pool_t *pool) {
+    size_t size = pool->slab_size;
+    // Large objects still need room for at least one of them.
+    if (size < sizeof(pool_slab_t) + pool->obj_size) {
+        size = sizeof(pool_slab_t) + pool->obj_size;
+    }
+    pool_slab_t *slab = (pool_slab_t *)malloc(size);
+    if (slab == NULL) {
+        return false;
+    }
+    slab->next = pool->slabs;
+    slab->size = size;
+    pool->slabs = slab;
+
+    // The header keeps objects 8-byte aligned; trailing bytes short of an object stay unused.
+    size_t objects = (size - sizeof(pool_slab_t)) / pool->obj_size;
+    pool->bump = (char *)(slab + 1);
+    pool->bump_end = pool->bump + objects * pool->obj_size;
+
+    if (pool->slab_size < POOL_SLAB_MAX) {
+        pool->slab_size *= 2;
+    }
+    return true;
+}
+
+/*
+ * Uvolnění všech objektů poolu najednou. Pool zůstane ve stavu po
+ * inicializaci a lze ho dále používat.
+ */
+void pool_release(pool_t *pool) {
+    pool_slab_t *slab = pool->slabs;
+    while (slab != NULL) {
+        pool_slab_t *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    pool_init(pool, pool->obj_size);
+}
+
+/*
+ * Inicializace areny. Paměť se alokuje až při prvním požadavku.
+ */
+void arena_init(arena_t *arena) {
+    arena->chunks = NULL;
+    arena->chunk_size = POOL_SLAB_MIN;
+    arena->used = 0;
+}
+
+/*
+ * Přidělí size bajtů bez zarovnání. Při nedostatku paměti vrací NULL.
+ */
+char *arena_alloc(arena_t *arena, size_t size) {
+    arena_chunk_t *chunk = arena->chunks;
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+        size_t data_size = arena->chunk_size;
+        // An oversized request gets a chunk of its own.
+        if (data_size < size) {
+            data_size = size;
+        }
+        chunk = (arena_chunk_t *)malloc(sizeof(arena_chunk_t) + data_size);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        chunk->next = arena->chunks;
+        chunk->size = data_size;
+        chunk->used = 0;
+        arena->chunks = chunk;
+        if (arena->chunk_size < POOL_SLAB_MAX) {
+            arena->chunk_size *= 2;
+        }
+    }
+    char *data = (char *)(chunk + 1) + chunk->used;
+    chunk->used += size;
+    arena->used += size;
+    return data;
+}
+
+/*
+ * Uvolnění všech úseků areny najednou. Arena zůstane ve stavu po
+ * inicializaci.
+ */
+void arena_release(arena_t *arena) {
+    arena_chunk_t *chunk = arena->chunks;
+    while (chunk != NULL) {
+        arena_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena_init(arena);
+}
@@ -0,0 +1,82 @@
+/*
+ * Alokátor paměti pro uzly pevné velikosti
+ *
+ * Pool přiděluje objekty jedné velikosti z velkých bloků (slabů). Uvolněné
+ * objekty se řadí do seznamu volných objektů, který je uložen přímo v nich,
+ * takže alokace i uvolnění jsou O(1). Funkce pool_release uvolní všechny
+ * objekty najednou po blocích, bez procházení jednotlivých objektů.
+ *
+ * Arena přiděluje bajtové úseky libovolné délky (např. řetězce) postupně
+ * z bloků a jednotlivě je neuvolňuje; uvolní je až arena_release.
+ */
+
+#ifndef IAL_POOL_H
+#define IAL_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Size of the first slab; every further slab is twice as large up to POOL_SLAB_MAX.
+#define POOL_SLAB_MIN 4096
+#define POOL_SLAB_MAX (2 * 1024 * 1024)
+
+typedef struct pool_slab {
+  struct pool_slab *next; // předchozí alokovaný blok
+  size_t size;            // velikost bloku v bajtech včetně hlavičky
+} pool_slab_t;
+
+typedef struct pool {
+  size_t obj_size;    // velikost objektu zarovnaná na 8 bajtů
+  size_t slab_size;   // velikost příštího bloku
+  pool_slab_t *slabs; // seznam alokovaných bloků
+  void *free_list;    // seznam uvolněných objektů
+  char *bump;         // první nepoužitý objekt nejnovějšího bloku
+  char *bump_end;     // konec objektů nejnovějšího bloku
+} pool_t;
+
+typedef struct arena_chunk {
+  struct arena_chunk *next; // předchozí alokovaný blok
+  size_t size;              // počet bajtů dat v bloku
+  size_t used;              // počet přidělených bajtů dat
+} arena_chunk_t;
+
+typedef struct arena {
+  arena_chunk_t *chunks; // seznam bloků, nejnovější první
+  size_t chunk_size;     // velikost dat příštího bloku
+  size_t used;           // celkový počet přidělených bajtů
+} arena_t;
+
+void pool_init(pool_t *pool, size_t obj_size);
+bool pool_grow(pool_t *pool);
+void pool_release(pool_t *pool);
+
+void arena_init(arena_t *arena);
+char *arena_alloc(arena_t *arena, size_t size);
+void arena_release(arena_t *arena);
+
+/*
+ * Přidělí jeden objekt. Při nedostatku paměti vrací NULL.
+ */
+static inline void *pool_alloc(pool_t *pool) {
+    void *obj = pool->free_list;
+    if (obj != NULL) {
+        pool->free_list = *(void **)obj;
+        return obj;
+    }
+    if (pool->bump == pool->bump_end && !pool_grow(pool)) {
+        return NULL;
+    }
+    obj = pool->bump;
+    pool->bump += pool->obj_size;
+    return obj;
+}
+
+/*
+ * Vrátí objekt přidělený z téhož poolu do seznamu volných objektů.
+ */
+static inline void pool_free(pool_t *pool, void *obj) {
+    *(void **)obj = pool->free_list;
+    pool->free_list = obj;
+}
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ * Počítadla práce tabulek a stromů
+ *
+ * Viz stats.h. Záznam vlákna je pole atomických slov se stejným
+ * rozložením jako stats_t. Vlastník do něj zapisuje relaxovaným čtením
+ * a zápisem (jiné vlákno do něj nepíše), stats_collect čte relaxovaně.
+ * Součet je tak bez datových závislostí mezi vlákny, jen nemusí zachytit
+ * operace, které právě probíhají.
+ */
+
+#include "stats.h"
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STATS_WORDS (sizeof(stats_t) / sizeof(uint64_t))
+
+_Static_assert(sizeof(stats_t) % sizeof(uint64_t) == 0, "stats_t must consist of uint64_t counters");
+_Static_assert(offsetof(stats_hist_t, bins) == 3 * sizeof(uint64_t), "stats_record relies on this layout");
+
+typedef struct stats_thread {
+    _Atomic uint64_t words[STATS_WORDS];  // stats_t of the thread, word by word
+    struct stats_thread *next;            // next registered record (records are never freed)
+} stats_thread_t;
+
+static _Atomic(stats_thread_t *) stats_threads = NULL;
+static _Thread_local stats_thread_t *stats_self = NULL;
+
+// Steps of the operation the calling thread is running, see STATS_STEP.
+_Thread_local uint64_t stats_steps = 0;
+
+/*
+ * Vrátí záznam volajícího vlákna, při prvním volání ho zaregistruje. Záznam
+ * přežije vlákno, aby jeho počty zůstaly v součtu. Při nedostatku paměti
+ * vrací NULL a počty vlákna se ztratí.
+ */
+static stats_thread_t *stats_thread_record(void) {
+    if (stats_self != NULL) {
+        return stats_self;
+    }
+    stats_thread_t *record = (stats_thread_t *)calloc(1, sizeof(stats_thread_t));
+    if (record == NULL) {
+        return NULL;
+    }
+    for (size_t word = 0; word < STATS_WORDS; word++) {
+        atomic_init(&record->words[word], 0);
+    }
+    // Lock-free push onto the registry.
+    stats_thread_t *head = atomic_load(&stats_threads);
+    do {
+        record->next = head;
+    } while (!atomic_compare_exchange_weak(&stats_threads, &head, record));
+    return stats_self = record;
+}
+
+static inline uint64_t stats_load(_Atomic uint64_t *word) {
+    return atomic_load_explicit(word, memory_order_relaxed);
+}
+
+static inline void stats_store(_Atomic uint64_t *word, uint64_t value) {
+    atomic_store_explicit(word, value, memory_order_relaxed);
+}
+
+/*
+ * Přičte count k počítadlu na pozici word záznamu volajícího vlákna.
+ */
+void stats_add(size_t word, uint64_t count) {
+    stats_thread_t *self = stats_thread_record();
+    if (self != NULL) {
+        // Only the owner writes, a plain load and store cannot lose an update.
+        stats_store(&self->words[word], stats_load(&self->words[word]) + count);
+    }
+}
+
+/*
+ * Přidá hodnotu value do histogramu, který začíná na pozici word.
+ */
+void stats_record(size_t word, uint64_t value) {
+    stats_thread_t *self = stats_thread_record();
+    if (self == NULL) {
+        return;
+    }
+    // The words of a stats_hist_t in order: count, sum, max and the bins.
+    _Atomic uint64_t *hist = &self->words[word];
+    size_t bin = 0;
+    while (bin < STATS_BINS - 1 && value >> bin != 0) {
+        bin++;
+    }
+    stats_store(&hist[0], stats_load(&hist[0]) + 1);
+    stats_store(&hist[1], stats_load(&hist[1]) + value);
+    if (value > stats_load(&hist[2])) {
+        stats_store(&hist[2], value);
+    }
+    stats_store(&hist[3 + bin], stats_load(&hist[3 + bin]) + 1);
+}
+
+/*
+ * Ukončí měřenou operaci: zapíše počet jejích kroků do histogramu na
+ * pozici word a počet kroků vynuluje.
+ */
+void stats_end(size_t word) {
+    stats_record(word, stats_steps);
+    stats_steps = 0;
+}
+
+static void stats_hist_merge(stats_hist_t *into, const stats_hist_t *from) {
+    into->count += from->count;
+    into->sum += from->sum;
+    into->max = from->max > into->max ? from->max : into->max;
+    for (size_t bin = 0; bin < STATS_BINS; bin++) {
+        into->bins[bin] += from->bins[bin];
+    }
+}
+
+/*
+ * Přičte záznam record do stats. Histogramy se sčítají po položkách, jen
+ * z maxim se bere větší.
+ */
+static void stats_merge(stats_t *stats, stats_thread_t *record) {
+    uint64_t words[STATS_WORDS];
+    for (size_t word = 0; word < STATS_WORDS; word++) {
+        words[word] = stats_load(&record->words[word]);
+    }
+    stats_t own;
+    memcpy(&own, words, sizeof(own));
+
+    stats_hist_merge(&stats->ht_probes, &own.ht_probes);
+    stats_hist_merge(&stats->ht_chain, &own.ht_chain);
+    stats->ht_inserts += own.ht_inserts;
+    stats->ht_deletes += own.ht_deletes;
+    stats->ht_resizes += own.ht_resizes;
+    stats->ht_allocs += own.ht_allocs;
+    stats_hist_merge(&stats->bst_search, &own.bst_search);
+    stats_hist_merge(&stats->bst_insert, &own.bst_insert);
+    stats_hist_merge(&stats->bst_delete, &own.bst_delete);
+    stats->bst_allocs += own.bst_allocs;
+}
+
+/*
+ * Součet počítadel všech vláken, která kdy něco zaznamenala.
+ */
+void stats_collect(stats_t *stats) {
+    memset(stats, 0, sizeof(stats_t));
+    for (stats_thread_t *record = atomic_load(&stats_threads); record != NULL; record = record->next) {
+        stats_merge(stats, record);
+    }
+}
+
+/*
+ * Počítadla volajícího vlákna.
+ */
+void stats_thread(stats_t *stats) {
+    memset(stats, 0, sizeof(stats_t));
+    if (stats_self != NULL) {
+        stats_merge(stats, stats_self);
+    }
+}
+
+/*
+ * Vynuluje počítadla všech vláken. Operace, které jiná vlákna právě
+ * zaznamenávají, se mohou do vynulovaného záznamu dopsat i s dřívějšími
+ * počty; přesný výsledek dává jen nulování v klidu.
+ */
+void stats_reset(void) {
+    for (stats_thread_t *record = atomic_load(&stats_threads); record != NULL; record = record->next) {
+        for (size_t word = 0; word < STATS_WORDS; word++) {
+            stats_store(&record->words[word], 0);
+        }
+    }
+}
+
+/*
+ * Výstup do bufferu, který hlídá jeho velikost a počítá i znaky, které se
+ * už nevešly.
+ */
+typedef struct stats_out {
+    char *buffer;  // destination, NULL when only measuring
+    size_t size;   // capacity of buffer including the terminating zero
+    size_t length; // characters produced so far, written or not
+} stats_out_t;
+
+static void stats_print(stats_out_t *out, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    size_t left = out->length < out->size ? out->size - out->length : 0;
+    int written = vsnprintf(left > 0 ? out->buffer + out->length : NULL, left, format, args);
+    va_end(args);
+    if (written > 0) {
+        out->length += (size_t)written;
+    }
+}
+
+static double stats_ratio(uint64_t part, uint64_t whole) {
+    return whole != 0 ? (double)part / (double)whole : 0.0;
+}
+
+static void stats_print_hist(stats_out_t *out, const char *name, const stats_hist_t *hist) {
+    stats_print(out, "\"%s\":{\"count\":%llu,\"avg\":%.3f,\"max\":%llu,\"log2_bins\":[", name,
+                (unsigned long long)hist->count, stats_ratio(hist->sum, hist->count),
+                (unsigned long long)hist->max);
+    for (size_t bin = 0; bin < STATS_BINS; bin++) {
+        stats_print(out, "%s%llu", bin > 0 ? "," : "", (unsigned long long)hist->bins[bin]);
+    }
+    stats_print(out, "]}");
+}
+
+/*
+ * Zapíše stats jako objekt JSON do buffer velikosti size (vždy ukončený
+ * nulou, pokud size > 0). Stejně jako snprintf vrací délku celého textu;
+ * je-li size menší nebo rovno, text se nevešel. Průměry jsou podíly
+ * sum / count, alokace na operaci se počítají na vložení a smazání.
+ */
+int stats_json(const stats_t *stats, char *buffer, size_t size) {
+    stats_out_t out = {.buffer = buffer, .size = size, .length = 0};
+    if (size > 0) {
+        buffer[0] = '\0';
+    }
+    stats_print(&out, "{\"ht\":{");
+    stats_print_hist(&out, "probes", &stats->ht_probes);
+    stats_print(&out, ",");
+    stats_print_hist(&out, "chain", &stats->ht_chain);
+    stats_print(&out, ",\"inserts\":%llu,\"deletes\":%llu,\"resizes\":%llu,\"allocs\":%llu,\"allocs_per_op\":%.3f},",
+                (unsigned long long)stats->ht_inserts, (unsigned long long)stats->ht_deletes,
+                (unsigned long long)stats->ht_resizes, (unsigned long long)stats->ht_allocs,
+                stats_ratio(stats->ht_allocs, stats->ht_inserts + stats->ht_deletes));
+    stats_print(&out, "\"bst\":{");
+    stats_print_hist(&out, "search", &stats->bst_search);
+    stats_print(&out, ",");
+    stats_print_hist(&out, "insert", &stats->bst_insert);
+    stats_print(&out, ",");
+    stats_print_hist(&out, "delete", &stats->bst_delete);
+    stats_print(&out, ",\"allocs\":%llu,\"allocs_per_op\":%.3f}}", (unsigned long long)stats->bst_allocs,
+                stats_ratio(stats->bst_allocs, stats->bst_insert.count + stats->bst_delete.count));
+    return (int)out.length;
+}
@@ -0,0 +1,91 @@
+/*
+ * Počítadla práce tabulek a stromů
+ *
+ * Při překladu s -DIAL_STATS zaznamenávají hashtable.c, hashtable_oa.c,
+ * varianty stromu a btree_pool.c, kolik práce dělají jednotlivé operace:
+ * počet porovnaných prvků (probes) a délku prohledaného seznamu synonym
+ * u každého vyhledání v tabulce, změny velikosti tabulek, alokace a hloubku
+ * sestupu stromem u bst_search, bst_insert a bst_delete. Degenerovaná
+ * rozptylovací funkce se tak projeví dlouhými seznamy a zdegenerovaný strom
+ * hlubokými sestupy dřív, než je vidět na latenci.
+ *
+ * Bez IAL_STATS jsou makra STATS_* prázdná, jejich argumenty se
+ * nevyhodnocují a do měřeného kódu se nepřeloží nic. Funkce stats_* jsou
+ * k dispozici vždy, jen pak vracejí nuly.
+ *
+ * Každé vlákno zapisuje jen do vlastního záznamu, bez zámků a bez
+ * atomických operací read-modify-write. Funkce stats_collect sečte záznamy
+ * všech vláken, i těch už ukončených, a smí se volat kdykoli za běhu.
+ *
+ *   stats_t stats;
+ *   char json[4096];
+ *   stats_collect(&stats);
+ *   stats_json(&stats, json, sizeof(json));
+ */
+
+#ifndef IAL_STATS_H
+#define IAL_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bins of a stats_hist_t: bin 0 counts zeros, bin k values from 2^(k-1) to 2^k - 1, the last one the rest.
+#define STATS_BINS 16
+
+/*
+ * Rozdělení jedné veličiny (počtu kroků) přes všechny operace.
+ */
+typedef struct stats_hist {
+  uint64_t count;             // počet operací
+  uint64_t sum;               // součet hodnot, průměr je sum / count
+  uint64_t max;               // největší hodnota
+  uint64_t bins[STATS_BINS];  // počty operací podle log2 hodnoty
+} stats_hist_t;
+
+/*
+ * Počítadla jednoho vlákna nebo součet všech vláken. Všechny položky jsou
+ * typu uint64_t.
+ */
+typedef struct stats {
+  stats_hist_t ht_probes;    // porovnané prvky na vyhledání v tabulce
+  stats_hist_t ht_chain;     // délka prohledaného seznamu synonym (zřetězené tabulky)
+  uint64_t ht_inserts;       // vložení do tabulky
+  uint64_t ht_deletes;       // smazání z tabulky
+  uint64_t ht_resizes;       // změny velikosti dynamické tabulky
+  uint64_t ht_allocs;        // alokace prvků, klíčů a polí tabulek
+  stats_hist_t bst_search;   // hloubka sestupu bst_search
+  stats_hist_t bst_insert;   // hloubka sestupu bst_insert
+  stats_hist_t bst_delete;   // hloubka sestupu bst_delete
+  uint64_t bst_allocs;       // alokace uzlů stromu
+} stats_t;
+
+void stats_collect(stats_t *stats);
+void stats_thread(stats_t *stats);
+void stats_reset(void);
+int stats_json(const stats_t *stats, char *buffer, size_t size);
+
+// Used by the STATS_* macros.
+extern _Thread_local uint64_t stats_steps;
+void stats_add(size_t word, uint64_t count);
+void stats_record(size_t word, uint64_t value);
+void stats_end(size_t word);
+
+#define STATS_WORD(field) (offsetof(stats_t, field) / sizeof(uint64_t))
+
+#ifdef IAL_STATS
+// Adds count to the counter field of the calling thread.
+#define STATS_COUNT(field, count) stats_add(STATS_WORD(field), (count))
+// Adds one value to the histogram field.
+#define STATS_RECORD(field, value) stats_record(STATS_WORD(field), (value))
+// One step of the running operation (a node visited, a key compared).
+#define STATS_STEP() ((void)stats_steps++)
+// The running operation is over: records its steps into the histogram field.
+#define STATS_END(field) stats_end(STATS_WORD(field))
+#else
+#define STATS_COUNT(field, count) ((void)0)
+#define STATS_RECORD(field, value) ((void)0)
+#define STATS_STEP() ((void)0)
+#define STATS_END(field) ((void)0)
+#endif
+
+#endif